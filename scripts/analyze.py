@@ -7,14 +7,26 @@ Usage
     python3 scripts/analyze.py                        # reads from project root
     python3 scripts/analyze.py --keypoints k.csv --matches m.csv
     python3 scripts/analyze.py --top 5               # show top 5 combinations
+    python3 scripts/analyze.py --keypoints keypoint_log.bin --matches match_log.bin
+    python3 scripts/analyze.py --dump keypoint_dump.bin   # summarise a per-row dump
+
+Binary logs (written with --binlog / --binlog-keypoints / --binlog-matches) are
+detected by their magic bytes and memory-mapped with numpy when it is
+installed; otherwise they are decoded with the struct module.
 """
 
 import argparse
 import csv
 import statistics
+import struct
 from collections import defaultdict
 from pathlib import Path
-from typing import Dict, List, Optional, Tuple
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+try:
+    import numpy as np
+except ImportError:  # numpy is optional; the struct fallback is just slower
+    np = None
 
 
 # ---------------------------------------------------------------------------
@@ -26,6 +38,117 @@ def load_csv(path: Path) -> List[Dict[str, str]]:
         return list(csv.DictReader(f))
 
 
+# ---------------------------------------------------------------------------
+# Binary columnar logs (see src/binaryLog.hpp for the layout)
+# ---------------------------------------------------------------------------
+
+BINLOG_MAGIC = b"FTCOLv1\0"
+_HEADER = struct.Struct("<8sIII44s")
+_COLUMN = struct.Struct("<28s8sI")
+_STRUCT_CODES = {"<u4": "I", "<i4": "i", "<f4": "f", "<f8": "d"}
+
+
+def is_binlog(path: Path) -> bool:
+    with path.open("rb") as f:
+        return f.read(len(BINLOG_MAGIC)) == BINLOG_MAGIC
+
+
+def read_binlog_schema(path: Path) -> Tuple[str, int, int, List[Tuple[str, str, int]]]:
+    """Return (record name, header bytes, record bytes, [(column, dtype, offset)])."""
+    with path.open("rb") as f:
+        magic, header_bytes, record_bytes, num_columns, name = _HEADER.unpack(f.read(_HEADER.size))
+        if magic != BINLOG_MAGIC:
+            raise ValueError(f"{path} is not a binary log")
+        columns = []
+        for _ in range(num_columns):
+            col, typ, offset = _COLUMN.unpack(f.read(_COLUMN.size))
+            columns.append((col.rstrip(b"\0").decode(), typ.rstrip(b"\0").decode(), offset))
+    return name.rstrip(b"\0").decode(), header_bytes, record_bytes, columns
+
+
+def load_binlog(path: Path) -> Dict[str, Sequence[Any]]:
+    """Load a binary log as {column: values}; string columns come back as str."""
+    _, header_bytes, record_bytes, columns = read_binlog_schema(path)
+    count = (path.stat().st_size - header_bytes) // record_bytes
+
+    if np is not None:
+        dtype = np.dtype({
+            "names": [c for c, _, _ in columns],
+            "formats": [t for _, t, _ in columns],
+            "offsets": [o for _, _, o in columns],
+            "itemsize": record_bytes,
+        })
+        if count == 0:
+            return {c: [] for c, _, _ in columns}
+        data = np.memmap(path, dtype=dtype, mode="r", offset=header_bytes, shape=(count,))
+        table: Dict[str, Sequence[Any]] = {}
+        for c, t, _ in columns:
+            table[c] = np.char.decode(data[c], "ascii") if t.startswith("|S") else data[c]
+        return table
+
+    # struct fallback: build one format string covering the whole record.
+    fmt, names, pos = "<", [], 0
+    for c, t, o in sorted(columns, key=lambda col: col[2]):
+        fmt += "x" * (o - pos)
+        if t.startswith("|S"):
+            width = int(t[2:])
+            fmt += f"{width}s"
+            pos = o + width
+        else:
+            fmt += _STRUCT_CODES[t]
+            pos = o + struct.calcsize("<" + _STRUCT_CODES[t])
+        names.append((c, t))
+    fmt += "x" * (record_bytes - pos)
+    table = {c: [] for c, _ in names}
+    with path.open("rb") as f:
+        f.seek(header_bytes)
+        raw = f.read(count * record_bytes)
+    for values in struct.iter_unpack(fmt, raw):
+        for (c, t), v in zip(names, values):
+            table[c].append(v.rstrip(b"\0").decode() if t.startswith("|S") else v)
+    return table
+
+
+# Binary column names differ in case from the CSV headers.
+_BIN_TO_CSV = {
+    "imageIndex": "ImageIndex",
+    "detectorType": "DetectorType",
+    "descriptorType": "DescriptorType",
+    "numKeypoints": "NumKeypoints",
+    "numMatches": "NumMatches",
+}
+
+
+def load_table(path: Path) -> Dict[str, Sequence[Any]]:
+    """Load a CSV or binary log into {CSV column name: values}."""
+    if is_binlog(path):
+        return {_BIN_TO_CSV.get(k, k): v for k, v in load_binlog(path).items()}
+    rows = load_csv(path)
+    if not rows:
+        return {}
+    return {k: [r[k] for r in rows] for k in rows[0]}
+
+
+def summarise_dump(path: Path) -> None:
+    """Per-column min/mean/max for a --binlog-keypoints / --binlog-matches dump."""
+    name, _, record_bytes, columns = read_binlog_schema(path)
+    table = load_binlog(path)
+    rows = len(next(iter(table.values()))) if table else 0
+    print(f"\n=== {path.name}: {name}, {rows} rows x {record_bytes} bytes ===")
+    for c, t, _ in columns:
+        if t.startswith("|S"):
+            continue
+        values = table[c]
+        if rows == 0:
+            continue
+        if np is not None:
+            print(f"  {c:<12s} min {float(np.min(values)):10.3f}  mean {float(np.mean(values)):10.3f}"
+                  f"  max {float(np.max(values)):10.3f}")
+        else:
+            print(f"  {c:<12s} min {min(values):10.3f}  mean {statistics.mean(values):10.3f}"
+                  f"  max {max(values):10.3f}")
+
+
 def _default_path(name: str) -> Path:
     """Walk up from this script to the project root and find the CSV."""
     here = Path(__file__).resolve().parent
@@ -37,10 +160,10 @@ def _default_path(name: str) -> Path:
 # Keypoint analysis
 # ---------------------------------------------------------------------------
 
-def analyse_keypoints(rows: List[Dict[str, str]], top: int) -> None:
+def analyse_keypoints(table: Dict[str, Sequence[Any]], top: int) -> None:
     per_detector: Dict[str, List[int]] = defaultdict(list)
-    for r in rows:
-        per_detector[r["DetectorType"]].append(int(r["NumKeypoints"]))
+    for det, n in zip(table.get("DetectorType", []), table.get("NumKeypoints", [])):
+        per_detector[str(det)].append(int(n))
 
     print("\n=== Keypoint counts per detector (avg over all images) ===")
     ranked = sorted(
@@ -56,11 +179,12 @@ def analyse_keypoints(rows: List[Dict[str, str]], top: int) -> None:
 # Match analysis
 # ---------------------------------------------------------------------------
 
-def analyse_matches(rows: List[Dict[str, str]], top: int) -> None:
+def analyse_matches(table: Dict[str, Sequence[Any]], top: int) -> None:
     combos: Dict[str, List[int]] = defaultdict(list)
-    for r in rows:
-        key = f"{r['DetectorType']}/{r['DescriptorType']}"
-        combos[key].append(int(r["NumMatches"]))
+    for det, desc, n in zip(table.get("DetectorType", []),
+                            table.get("DescriptorType", []),
+                            table.get("NumMatches", [])):
+        combos[f"{det}/{desc}"].append(int(n))
 
     ranked = sorted(
         [(k, statistics.mean(v), min(v), max(v)) for k, v in combos.items()],
@@ -90,13 +214,13 @@ def main() -> None:
         "--keypoints",
         type=Path,
         default=None,
-        help="Path to keypoint_log.csv (default: <project_root>/keypoint_log.csv)",
+        help="Path to keypoint_log.csv or keypoint_log.bin (default: <project_root>/keypoint_log.csv)",
     )
     parser.add_argument(
         "--matches",
         type=Path,
         default=None,
-        help="Path to match_log.csv (default: <project_root>/match_log.csv)",
+        help="Path to match_log.csv or match_log.bin (default: <project_root>/match_log.csv)",
     )
     parser.add_argument(
         "--top",
@@ -104,8 +228,23 @@ def main() -> None:
         default=10,
         help="Number of top/bottom combinations to display (default: 10)",
     )
+    parser.add_argument(
+        "--dump",
+        type=Path,
+        action="append",
+        default=[],
+        help="Binary per-keypoint/per-match dump to summarise (repeatable)",
+    )
     args = parser.parse_args()
 
+    for dump in args.dump:
+        if not dump.exists():
+            print(f"[ERROR] Dump not found: {dump}")
+            raise SystemExit(1)
+        summarise_dump(dump)
+    if args.dump and args.keypoints is None and args.matches is None:
+        return
+
     kpt_path = args.keypoints or _default_path("keypoint_log.csv")
     match_path = args.matches or _default_path("match_log.csv")
 
@@ -119,11 +258,8 @@ def main() -> None:
         print("  Run the tracker first: cd build && ./2D_feature_tracking")
         raise SystemExit(1)
 
-    kpt_rows   = load_csv(kpt_path)
-    match_rows = load_csv(match_path)
-
-    analyse_keypoints(kpt_rows, args.top)
-    analyse_matches(match_rows, args.top)
+    analyse_keypoints(load_table(kpt_path), args.top)
+    analyse_matches(load_table(match_path), args.top)
 
 
 if __name__ == "__main__":
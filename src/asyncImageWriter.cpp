@@ -0,0 +1,124 @@
+#include <iostream>
+#include <opencv2/imgcodecs.hpp>
+
+#include "asyncImageWriter.hpp"
+
+using namespace std;
+
+DropPolicy parseDropPolicy(const string &name)
+{
+    if (name == "BLOCK")  return DropPolicy::BLOCK;
+    if (name == "NEWEST") return DropPolicy::DROP_NEWEST;
+    if (name == "OLDEST") return DropPolicy::DROP_OLDEST;
+    throw invalid_argument("parseDropPolicy: unknown drop policy '" + name + "'");
+}
+
+AsyncImageWriter::AsyncImageWriter(const ImageWriterOptions &options)
+    : options_(options)
+{
+    if (options_.workers < 1 || options_.queueCapacity < 1)
+        throw invalid_argument("AsyncImageWriter: need at least one worker and one queue slot");
+
+    if (options_.format == "PNG")
+    {
+        extension_    = ".png";
+        encodeParams_ = {cv::IMWRITE_PNG_COMPRESSION, options_.pngCompression};
+    }
+    else if (options_.format == "JPG" || options_.format == "JPEG")
+    {
+        extension_    = ".jpg";
+        encodeParams_ = {cv::IMWRITE_JPEG_QUALITY, options_.jpegQuality};
+    }
+    else
+    {
+        throw invalid_argument("AsyncImageWriter: unknown image format '" + options_.format + "'");
+    }
+
+    for (int i = 0; i < options_.workers; ++i)
+        workers_.emplace_back(&AsyncImageWriter::workerLoop, this);
+}
+
+AsyncImageWriter::~AsyncImageWriter()
+{
+    close();
+}
+
+void AsyncImageWriter::close()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    notEmpty_.notify_all();
+    notFull_.notify_all();
+    for (auto &w : workers_)
+        w.join();
+    workers_.clear();
+}
+
+void AsyncImageWriter::submit(MatchImageJob job)
+{
+    // Frames from the stream/shm ingest modes wrap recycled buffers (no
+    // allocator-owned data); those must be copied before the slot is reused.
+    if (!job.img1.u) job.img1 = job.img1.clone();
+    if (!job.img2.u) job.img2 = job.img2.clone();
+
+    unique_lock<mutex> lock(mutex_);
+    if (queue_.size() >= options_.queueCapacity)
+    {
+        switch (options_.dropPolicy)
+        {
+        case DropPolicy::BLOCK:
+            notFull_.wait(lock, [this] { return queue_.size() < options_.queueCapacity || stopping_; });
+            break;
+        case DropPolicy::DROP_NEWEST:
+            ++dropped_;
+            return;
+        case DropPolicy::DROP_OLDEST:
+            queue_.pop_front();
+            ++dropped_;
+            break;
+        }
+    }
+    queue_.push_back(std::move(job));
+    lock.unlock();
+    notEmpty_.notify_one();
+}
+
+void AsyncImageWriter::workerLoop()
+{
+    for (;;)
+    {
+        MatchImageJob job;
+        {
+            unique_lock<mutex> lock(mutex_);
+            notEmpty_.wait(lock, [this] { return !queue_.empty() || stopping_; });
+            if (queue_.empty())
+                return; // stopping and drained
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        notFull_.notify_one();
+
+        try
+        {
+            cv::Mat matchImg;
+            cv::drawMatches(job.img1, job.keypoints1, job.img2, job.keypoints2,
+                            job.matches, matchImg,
+                            cv::Scalar::all(-1), cv::Scalar::all(-1),
+                            vector<char>(),
+                            cv::DrawMatchesFlags::DRAW_RICH_KEYPOINTS);
+
+            const string path = job.pathStem + extension_;
+            if (cv::imwrite(path, matchImg, encodeParams_))
+                ++written_;
+            else
+                cerr << "[WARN] AsyncImageWriter: could not write '" << path << "'\n";
+        }
+        catch (const exception &e)
+        {
+            // A failed encode must not take the writer thread (and the process) down.
+            cerr << "[WARN] AsyncImageWriter: " << e.what() << "\n";
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef asyncImageWriter_hpp
+#define asyncImageWriter_hpp
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdexcept>
+
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+// What to do when a frame's image is submitted while the queue is full.
+enum class DropPolicy
+{
+    BLOCK,        // wait for a free slot (output complete, latency affected)
+    DROP_NEWEST,  // discard the image being submitted
+    DROP_OLDEST   // discard the oldest queued image to make room
+};
+
+struct ImageWriterOptions
+{
+    int        workers        = 1;
+    size_t     queueCapacity  = 8;
+    DropPolicy dropPolicy     = DropPolicy::BLOCK;
+    std::string format        = "PNG"; // PNG or JPG
+    int        pngCompression = 1;     // 0-9, 1 favours speed
+    int        jpegQuality    = 90;    // 0-100
+};
+
+// A deferred cv::drawMatches + cv::imwrite for one frame pair.
+struct MatchImageJob
+{
+    cv::Mat img1, img2;
+    std::vector<cv::KeyPoint> keypoints1, keypoints2;
+    std::vector<cv::DMatch> matches;
+    std::string pathStem; // output path without extension
+};
+
+// Draws and encodes match visualisations on background threads so --save does
+// not stall the compute thread. The destructor finishes all queued jobs.
+class AsyncImageWriter
+{
+  public:
+    // Throws std::invalid_argument on bad options.
+    explicit AsyncImageWriter(const ImageWriterOptions &options);
+    ~AsyncImageWriter();
+
+    AsyncImageWriter(const AsyncImageWriter &) = delete;
+    AsyncImageWriter &operator=(const AsyncImageWriter &) = delete;
+
+    // Queue a job, applying the drop policy if the queue is full.
+    void submit(MatchImageJob job);
+
+    // Finish all queued jobs and stop the workers; called by the destructor.
+    void close();
+
+    size_t written() const { return written_.load(); }
+    size_t dropped() const { return dropped_.load(); }
+
+  private:
+    void workerLoop();
+
+    ImageWriterOptions options_;
+    std::string extension_;
+    std::vector<int> encodeParams_;
+
+    std::mutex mutex_;
+    std::condition_variable notEmpty_, notFull_;
+    std::deque<MatchImageJob> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    std::atomic<size_t> written_{0}, dropped_{0};
+};
+
+// Parse "block" / "newest" / "oldest" (upper-cased); throws std::invalid_argument otherwise.
+DropPolicy parseDropPolicy(const std::string &name);
+
+#endif /* asyncImageWriter_hpp */
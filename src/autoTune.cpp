@@ -0,0 +1,120 @@
+#include <iostream>
+#include <algorithm>
+
+#include "autoTune.hpp"
+
+using namespace std;
+
+// ---------------------------------------------------------------------------
+// Measurement
+// ---------------------------------------------------------------------------
+static TuneCandidate measure(const vector<FrameResult> &results)
+{
+    TuneCandidate c;
+    // Frame 0 has nothing to match against and pays one-off initialisation.
+    for (size_t i = 1; i < results.size(); ++i)
+    {
+        const FrameResult &r = results[i];
+        const double ms = r.detectMs + r.describeMs + r.matchMs;
+        c.meanMs      += ms;
+        c.maxMs        = max(c.maxMs, ms);
+        c.meanMatches += (double)r.numMatches;
+        ++c.frames;
+    }
+    if (c.frames)
+    {
+        c.meanMs      /= (double)c.frames;
+        c.meanMatches /= (double)c.frames;
+    }
+    return c;
+}
+
+// A candidate is on the front when every faster one yields fewer matches.
+static void markParetoFront(vector<TuneCandidate> &candidates)
+{
+    vector<TuneCandidate *> byLatency;
+    for (auto &c : candidates)
+        byLatency.push_back(&c);
+    stable_sort(byLatency.begin(), byLatency.end(),
+                [](const TuneCandidate *a, const TuneCandidate *b) {
+                    return a->meanMs < b->meanMs
+                           || (a->meanMs == b->meanMs && a->meanMatches > b->meanMatches);
+                });
+
+    double bestMatches = -1.0;
+    for (TuneCandidate *c : byLatency)
+    {
+        c->pareto = c->meanMatches > bestMatches;
+        bestMatches = max(bestMatches, c->meanMatches);
+    }
+}
+
+TuneResult runAutoTune(const ImageSequence &sequence, const PipelineSettings &settings,
+                       const PipelineOutputs &outputs, double budgetMs,
+                       const vector<string> &detectors, const vector<string> &descriptors,
+                       const vector<string> &matchers)
+{
+    const FeatureRegistry &registry = FeatureRegistry::instance();
+    TuneResult result;
+
+    for (const string &det : detectors)
+        for (const string &desc : descriptors)
+            for (const string &mat : matchers)
+            {
+                try
+                {
+                    if (!registry.compatible(det, desc))
+                        continue;
+                    // A matcher without a path for this norm would only re-run MAT_BF.
+                    if (!matcherApplies(parseMatcherKind(mat), isBinaryDescriptor(desc)))
+                        continue;
+
+                    PipelineSettings s = settings;
+                    s.matcherType = mat;
+                    cout << "\n=== Autotune: " << det << " + " << desc << " + " << mat << " ===" << endl;
+
+                    FramePipeline pipeline(det, desc, s, outputs);
+                    TuneCandidate c = measure(runImageSequence(pipeline, sequence));
+                    c.detector   = det;
+                    c.descriptor = desc;
+                    c.matcher    = mat;
+                    c.withinBudget = c.frames > 0 && c.meanMs <= budgetMs;
+                    result.candidates.push_back(c);
+                }
+                catch (const exception &e)
+                {
+                    cerr << "[ERROR] " << det << "+" << desc << "+" << mat << ": " << e.what() << "\n";
+                }
+            }
+
+    markParetoFront(result.candidates);
+
+    // On the front, more matches always cost more time, so the best
+    // configuration within budget is the slowest front member that fits.
+    for (size_t i = 0; i < result.candidates.size(); ++i)
+    {
+        const TuneCandidate &c = result.candidates[i];
+        if (c.pareto && c.withinBudget
+            && (result.best < 0 || c.meanMatches > result.candidates[result.best].meanMatches))
+            result.best = (int)i;
+    }
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Report
+// ---------------------------------------------------------------------------
+void writeTuneReport(ostream &out, const TuneResult &result)
+{
+    vector<const TuneCandidate *> rows;
+    for (const auto &c : result.candidates)
+        rows.push_back(&c);
+    stable_sort(rows.begin(), rows.end(),
+                [](const TuneCandidate *a, const TuneCandidate *b) { return a->meanMs < b->meanMs; });
+
+    out << "Detector,Descriptor,Matcher,MeanMs,MaxMs,MeanMatches,Frames,Pareto,WithinBudget\n";
+    for (const TuneCandidate *c : rows)
+        out << c->detector << "," << c->descriptor << "," << c->matcher << ","
+            << c->meanMs << "," << c->maxMs << "," << c->meanMatches << "," << c->frames << ","
+            << (c->pareto ? 1 : 0) << "," << (c->withinBudget ? 1 : 0) << "\n";
+}
@@ -0,0 +1,49 @@
+#ifndef autoTune_hpp
+#define autoTune_hpp
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "framePipeline.hpp"
+#include "pipelineRunners.hpp"
+
+// ---------------------------------------------------------------------------
+// Latency-budget auto-tuning (--autotune MS).
+//
+// Runs every compatible detector / descriptor / matcher combination over an
+// image sequence, measures steady-state per-frame latency (detect + describe
+// + match, first frame excluded) and match yield, and marks the Pareto front:
+// configurations that no other one beats on both latency and matches.
+// ---------------------------------------------------------------------------
+struct TuneCandidate
+{
+    std::string detector, descriptor, matcher;
+    double meanMs      = 0.0;   // per frame, frames 1..N
+    double maxMs       = 0.0;
+    double meanMatches = 0.0;
+    size_t frames      = 0;     // frames that were timed
+    bool   pareto      = false;
+    bool   withinBudget = false;
+};
+
+struct TuneResult
+{
+    std::vector<TuneCandidate> candidates;  // in sweep order
+    int best = -1;                          // most matches within budget; -1 if none fits
+};
+
+// Combinations that fail to build (missing contrib module, incompatible
+// descriptor) are skipped with a message on stderr. Timings are only
+// meaningful without a result cache, so outputs.cache should be null.
+TuneResult runAutoTune(const ImageSequence &sequence, const PipelineSettings &settings,
+                       const PipelineOutputs &outputs, double budgetMs,
+                       const std::vector<std::string> &detectors,
+                       const std::vector<std::string> &descriptors,
+                       const std::vector<std::string> &matchers);
+
+// CSV of every candidate, fastest first:
+// Detector,Descriptor,Matcher,MeanMs,MaxMs,MeanMatches,Frames,Pareto,WithinBudget
+void writeTuneReport(std::ostream &out, const TuneResult &result);
+
+#endif /* autoTune_hpp */
@@ -0,0 +1,128 @@
+#include <cstddef>
+#include <algorithm>
+
+#include "binaryLog.hpp"
+
+using namespace std;
+
+static const char kBinaryLogMagic[8] = {'F', 'T', 'C', 'O', 'L', 'v', '1', '\0'};
+
+// ---------------------------------------------------------------------------
+// Schemas: one entry per field, in declaration order.
+// ---------------------------------------------------------------------------
+#define COLUMN(Record, field, type) BinaryColumnSpec{#field, type, (uint32_t)offsetof(Record, field)}
+
+const vector<BinaryColumnSpec> &keypointLogSchema()
+{
+    static const vector<BinaryColumnSpec> schema = {
+        COLUMN(KeypointLogRecord, imageIndex,   "<u4"),
+        COLUMN(KeypointLogRecord, detectorType, "|S16"),
+        COLUMN(KeypointLogRecord, numKeypoints, "<u4"),
+        COLUMN(KeypointLogRecord, minSize,      "<f4"),
+        COLUMN(KeypointLogRecord, maxSize,      "<f4"),
+        COLUMN(KeypointLogRecord, meanSize,     "<f4"),
+        COLUMN(KeypointLogRecord, detectMs,     "<f4"),
+    };
+    return schema;
+}
+
+const vector<BinaryColumnSpec> &matchLogSchema()
+{
+    static const vector<BinaryColumnSpec> schema = {
+        COLUMN(MatchLogRecord, imageIndex,     "<u4"),
+        COLUMN(MatchLogRecord, detectorType,   "|S16"),
+        COLUMN(MatchLogRecord, descriptorType, "|S16"),
+        COLUMN(MatchLogRecord, numMatches,     "<u4"),
+        COLUMN(MatchLogRecord, matchMs,        "<f4"),
+    };
+    return schema;
+}
+
+const vector<BinaryColumnSpec> &keypointDumpSchema()
+{
+    static const vector<BinaryColumnSpec> schema = {
+        COLUMN(KeypointDumpRecord, imageIndex,   "<u4"),
+        COLUMN(KeypointDumpRecord, detectorType, "|S16"),
+        COLUMN(KeypointDumpRecord, x,            "<f4"),
+        COLUMN(KeypointDumpRecord, y,            "<f4"),
+        COLUMN(KeypointDumpRecord, size,         "<f4"),
+        COLUMN(KeypointDumpRecord, angle,        "<f4"),
+        COLUMN(KeypointDumpRecord, response,     "<f4"),
+        COLUMN(KeypointDumpRecord, octave,       "<i4"),
+    };
+    return schema;
+}
+
+const vector<BinaryColumnSpec> &matchDumpSchema()
+{
+    static const vector<BinaryColumnSpec> schema = {
+        COLUMN(MatchDumpRecord, imageIndex,     "<u4"),
+        COLUMN(MatchDumpRecord, detectorType,   "|S16"),
+        COLUMN(MatchDumpRecord, descriptorType, "|S16"),
+        COLUMN(MatchDumpRecord, queryIdx,       "<i4"),
+        COLUMN(MatchDumpRecord, trainIdx,       "<i4"),
+        COLUMN(MatchDumpRecord, distance,       "<f4"),
+    };
+    return schema;
+}
+
+#undef COLUMN
+
+// ---------------------------------------------------------------------------
+// BinaryLog
+// ---------------------------------------------------------------------------
+static vector<char> buildHeader(const string &recordName,
+                                const vector<BinaryColumnSpec> &schema, uint32_t recordBytes)
+{
+    const size_t used  = sizeof(BinaryLogHeader) + schema.size() * sizeof(BinaryLogColumn);
+    const size_t total = (used + 63) & ~size_t(63); // records start cache-line aligned
+
+    vector<char> bytes(total, 0);
+    BinaryLogHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, kBinaryLogMagic, sizeof(hdr.magic));
+    hdr.headerBytes = (uint32_t)total;
+    hdr.recordBytes = recordBytes;
+    hdr.numColumns  = (uint32_t)schema.size();
+    setName(hdr.recordName, recordName);
+    memcpy(bytes.data(), &hdr, sizeof(hdr));
+
+    char *p = bytes.data() + sizeof(hdr);
+    for (const auto &col : schema)
+    {
+        BinaryLogColumn c;
+        setName(c.name, col.name);
+        setName(c.type, col.type);
+        c.offset = col.offset;
+        memcpy(p, &c, sizeof(c));
+        p += sizeof(c);
+    }
+    return bytes;
+}
+
+BinaryLog::BinaryLog(const string &path, const string &recordName,
+                     const vector<BinaryColumnSpec> &schema, uint32_t recordBytes)
+    : recordBytes_(recordBytes)
+{
+    const vector<char> header = buildHeader(recordName, schema, recordBytes);
+
+    ifstream existing(path, ios::binary | ios::ate);
+    const streamoff existingBytes = existing ? (streamoff)existing.tellg() : 0;
+    if (existingBytes > 0)
+    {
+        // Appending to an earlier run: the schema has to be identical.
+        vector<char> onDisk(header.size());
+        existing.seekg(0);
+        if (!existing.read(onDisk.data(), (streamsize)onDisk.size()) || onDisk != header)
+            throw runtime_error("BinaryLog: '" + path + "' has a different schema; move it aside");
+        if ((existingBytes - (streamoff)header.size()) % recordBytes != 0)
+            throw runtime_error("BinaryLog: '" + path + "' ends in a partial record");
+    }
+    existing.close();
+
+    out_.open(path, ios::binary | ios::app);
+    if (!out_)
+        throw runtime_error("BinaryLog: could not open '" + path + "' for writing");
+    if (existingBytes == 0)
+        out_.write(header.data(), (streamsize)header.size());
+}
@@ -0,0 +1,137 @@
+#ifndef binaryLog_hpp
+#define binaryLog_hpp
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+
+// ---------------------------------------------------------------------------
+// Append-only binary log of fixed-width records.
+//
+// File layout (little-endian):
+//   BinaryLogHeader                      64 bytes
+//   BinaryLogColumn x numColumns         40 bytes each
+//   zero padding up to headerBytes       (multiple of 64)
+//   record x N                           recordBytes each
+//
+// Column types are numpy dtype strings ("<u4", "<i4", "<f4", "|S16"), so the
+// record area can be memory-mapped directly as a structured array.
+// ---------------------------------------------------------------------------
+
+struct BinaryLogHeader
+{
+    char     magic[8];      // "FTCOLv1\0"
+    uint32_t headerBytes;   // offset of the first record
+    uint32_t recordBytes;
+    uint32_t numColumns;
+    char     recordName[44];
+};
+static_assert(sizeof(BinaryLogHeader) == 64, "BinaryLogHeader layout is part of the file format");
+
+struct BinaryLogColumn
+{
+    char     name[28];
+    char     type[8];
+    uint32_t offset;
+};
+static_assert(sizeof(BinaryLogColumn) == 40, "BinaryLogColumn layout is part of the file format");
+
+struct BinaryColumnSpec
+{
+    const char *name;
+    const char *type;
+    uint32_t offset;
+};
+
+/* --- Record types --- */
+// Fixed-size name fields are NUL-padded.
+
+struct KeypointLogRecord   // one row per frame, mirrors keypoint_log.csv
+{
+    uint32_t imageIndex;
+    char     detectorType[16];
+    uint32_t numKeypoints;
+    float    minSize, maxSize, meanSize;
+    float    detectMs;
+};
+
+struct MatchLogRecord      // one row per frame pair, mirrors match_log.csv
+{
+    uint32_t imageIndex;
+    char     detectorType[16];
+    char     descriptorType[16];
+    uint32_t numMatches;
+    float    matchMs;
+};
+
+struct KeypointDumpRecord  // one row per ROI keypoint
+{
+    uint32_t imageIndex;
+    char     detectorType[16];
+    float    x, y, size, angle, response;
+    int32_t  octave;
+};
+
+struct MatchDumpRecord     // one row per surviving match
+{
+    uint32_t imageIndex;
+    char     detectorType[16];
+    char     descriptorType[16];
+    int32_t  queryIdx, trainIdx;
+    float    distance;
+};
+
+const std::vector<BinaryColumnSpec> &keypointLogSchema();
+const std::vector<BinaryColumnSpec> &matchLogSchema();
+const std::vector<BinaryColumnSpec> &keypointDumpSchema();
+const std::vector<BinaryColumnSpec> &matchDumpSchema();
+
+// Copy a name into a fixed-width, NUL-padded field (truncating if needed).
+template <size_t N>
+void setName(char (&field)[N], const std::string &value)
+{
+    std::memset(field, 0, N);
+    std::memcpy(field, value.data(), std::min(value.size(), N - 1));
+}
+
+class BinaryLog
+{
+  public:
+    // Opens `path` for appending. A new file gets the schema header; an
+    // existing one must carry exactly the same schema.
+    // Throws std::runtime_error on I/O failure or schema mismatch.
+    BinaryLog(const std::string &path, const std::string &recordName,
+              const std::vector<BinaryColumnSpec> &schema, uint32_t recordBytes);
+
+    template <class Record>
+    void append(const Record &rec)
+    {
+        static_assert(std::is_trivially_copyable<Record>::value, "records are written bytewise");
+        if (sizeof(Record) != recordBytes_)
+            throw std::logic_error("BinaryLog::append: record size does not match schema");
+        out_.write(reinterpret_cast<const char *>(&rec), sizeof(Record));
+    }
+
+    template <class Record>
+    void append(const std::vector<Record> &recs)
+    {
+        if (recs.empty()) return;
+        if (sizeof(Record) != recordBytes_)
+            throw std::logic_error("BinaryLog::append: record size does not match schema");
+        out_.write(reinterpret_cast<const char *>(recs.data()),
+                   (std::streamsize)(recs.size() * sizeof(Record)));
+    }
+
+    void flush() { out_.flush(); }
+
+  private:
+    std::ofstream out_;
+    uint32_t recordBytes_;
+};
+
+#endif /* binaryLog_hpp */
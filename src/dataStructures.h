@@ -14,5 +14,15 @@ struct DataFrame { // represents the available sensor information at the same ti
     std::vector<cv::DMatch> kptMatches; // keypoint matches between previous and current frame
 };
 
+struct FrameResult { // per-frame outcome of the pipeline, as reported to logs and stream consumers
+
+    size_t numKeypoints = 0; // keypoints kept after ROI filtering
+    size_t numDescribeDropped = 0; // of those, dropped by the extractor (e.g. too near the border)
+    size_t numMatches = 0;   // matches against the previous frame (0 for the first frame)
+    double detectMs = 0.0;   // wall time of each stage in milliseconds
+    double describeMs = 0.0;
+    double matchMs = 0.0;
+};
+
 
 #endif /* dataStructures_h */
@@ -0,0 +1,171 @@
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include "descriptorArena.hpp"
+
+using namespace std;
+
+static const size_t kBlockAlign = kDescriptorAlign;   // cache line; AVX-512 loads stay aligned
+
+DescriptorArena &DescriptorArena::instance()
+{
+    static DescriptorArena *arena = new DescriptorArena();   // never destroyed, see header
+    return *arena;
+}
+
+size_t DescriptorArena::sizeClass(size_t bytes)
+{
+    size_t c = 4096;
+    while (c < bytes)
+        c <<= 1;
+    return c;
+}
+
+void *DescriptorArena::takeBlock(size_t blockBytes) const
+{
+    vector<void *> &list = free_[blockBytes];
+    if (!list.empty())
+    {
+        void *p = list.back();
+        list.pop_back();
+        ++reused_;
+        return p;
+    }
+    void *p = aligned_alloc(kBlockAlign, blockBytes);   // blockBytes is a multiple of 64
+    if (!p)
+        throw bad_alloc();
+    ++allocated_;
+    return p;
+}
+
+void DescriptorArena::reserve(size_t bytes, size_t blocks)
+{
+    const size_t blockBytes = sizeClass(bytes);
+    lock_guard<mutex> lock(mutex_);
+    vector<void *> &list = free_[blockBytes];
+    while (list.size() < min(blocks, kMaxFreePerClass))
+    {
+        void *p = aligned_alloc(kBlockAlign, blockBytes);
+        if (!p)
+            throw bad_alloc();
+        ++allocated_;
+        list.push_back(p);
+    }
+}
+
+size_t DescriptorArena::reused() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return reused_;
+}
+
+size_t DescriptorArena::allocated() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return allocated_;
+}
+
+// ---------------------------------------------------------------------------
+// cv::MatAllocator interface (mirrors OpenCV's StdMatAllocator)
+// ---------------------------------------------------------------------------
+cv::UMatData *DescriptorArena::allocate(int dims, const int *sizes, int type, void *data,
+                                        size_t *step, cv::AccessFlag flags,
+                                        cv::UMatUsageFlags usageFlags) const
+{
+    if (data)   // wrapping user memory: nothing to recycle
+        return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; --i)
+    {
+        if (step)
+            step[i] = total;
+        total *= (size_t)sizes[i];
+    }
+
+    const size_t blockBytes = sizeClass(total);
+    void *block;
+    {
+        lock_guard<mutex> lock(mutex_);
+        block = takeBlock(blockBytes);
+    }
+    cv::UMatData *u = new cv::UMatData(this);
+    u->data = u->origdata = static_cast<uchar *>(block);
+    u->size = blockBytes;
+    return u;
+}
+
+bool DescriptorArena::allocate(cv::UMatData *u, cv::AccessFlag, cv::UMatUsageFlags) const
+{
+    return u != nullptr;
+}
+
+void DescriptorArena::deallocate(cv::UMatData *u) const
+{
+    if (!u)
+        return;
+    CV_Assert(u->urefcount == 0 && u->refcount == 0);
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED) && u->origdata)
+    {
+        lock_guard<mutex> lock(mutex_);
+        vector<void *> &list = free_[u->size];
+        if (list.size() < kMaxFreePerClass)
+            list.push_back(u->origdata);
+        else
+            free(u->origdata);
+        u->origdata = nullptr;
+    }
+    delete u;
+}
+
+// ---------------------------------------------------------------------------
+// Padded layout
+// ---------------------------------------------------------------------------
+cv::Mat createPaddedDescriptors(int rows, int cols, int type)
+{
+    const size_t elemSize = CV_ELEM_SIZE(type);
+    const size_t rowBytes = (size_t)cols * elemSize;
+    const size_t stride   = paddedRowBytes(rowBytes);
+
+    cv::Mat block;
+    block.allocator = &DescriptorArena::instance();
+    block.create(rows, (int)(stride / elemSize), type);   // 64 divides by any element size
+    for (int r = 0; r < rows; ++r)
+        memset(block.ptr(r) + rowBytes, 0, stride - rowBytes);
+    return block.colRange(0, cols);
+}
+
+void padDescriptorRows(const cv::Mat &packed, cv::Mat &padded)
+{
+    if (packed.empty() || hasPaddedRows(packed))
+    {
+        padded = packed;
+        return;
+    }
+    cv::Mat out = createPaddedDescriptors(packed.rows, packed.cols, packed.type());
+    const size_t rowBytes = (size_t)packed.cols * packed.elemSize();
+    for (int r = 0; r < packed.rows; ++r)
+        memcpy(out.ptr(r), packed.ptr(r), rowBytes);
+    padded = out;
+}
+
+void quantizeDescriptorRows(const cv::Mat &floats, cv::Mat &bytes)
+{
+    if (floats.empty())
+    {
+        bytes = floats;
+        return;
+    }
+    cv::Mat out = createPaddedDescriptors(floats.rows, floats.cols, CV_8U);
+    floats.convertTo(out, CV_8U);   // same size and type: fills the view in place
+    bytes = out;
+}
+
+bool hasPaddedRows(const cv::Mat &descriptors)
+{
+    return !descriptors.empty()
+           && reinterpret_cast<uintptr_t>(descriptors.data) % kDescriptorAlign == 0
+           && descriptors.step[0] == paddedRowBytes((size_t)descriptors.cols * descriptors.elemSize());
+}
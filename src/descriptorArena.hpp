@@ -0,0 +1,90 @@
+#ifndef descriptorArena_hpp
+#define descriptorArena_hpp
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <mutex>
+
+#include <opencv2/core.hpp>
+
+// ---------------------------------------------------------------------------
+// Recycling allocator for descriptor matrices.
+//
+// Set as a cv::Mat's allocator before an extractor writes into it, so the
+// extractor's create() draws a 64-byte aligned block from a free list instead
+// of the heap. Blocks come back when the last Mat referencing them goes away
+// (ring buffer eviction, dump writer done), so in steady state a frame's
+// descriptors cost no allocation. Requests are rounded up to power-of-two
+// size classes (>= 4 KiB); user-supplied data goes to OpenCV's allocator.
+//
+// A process-wide singleton: descriptor Mats can outlive the pipeline that
+// made them (queued dumps), so the arena must outlive every Mat. Thread-safe.
+// ---------------------------------------------------------------------------
+class DescriptorArena : public cv::MatAllocator
+{
+  public:
+    static DescriptorArena &instance();
+
+    // Make sure `blocks` blocks of at least `bytes` are ready (e.g. keypoint
+    // budget x descriptor row bytes, one per buffered frame and one spare).
+    void reserve(size_t bytes, size_t blocks);
+
+    size_t reused()    const;   // allocations served from the free list
+    size_t allocated() const;   // blocks taken from the heap
+
+    cv::UMatData *allocate(int dims, const int *sizes, int type, void *data, size_t *step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override;
+    bool allocate(cv::UMatData *data, cv::AccessFlag accessFlags,
+                  cv::UMatUsageFlags usageFlags) const override;
+    void deallocate(cv::UMatData *data) const override;
+
+  private:
+    DescriptorArena() = default;
+
+    static size_t sizeClass(size_t bytes);
+    void *takeBlock(size_t blockBytes) const;   // caller holds mutex_
+
+    static constexpr size_t kMaxFreePerClass = 16;  // more than this go back to the heap
+
+    mutable std::mutex mutex_;
+    mutable std::map<size_t, std::vector<void *>> free_;
+    mutable size_t reused_ = 0, allocated_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Padded descriptor layout for SIMD matching.
+//
+// Each row starts on a 64-byte boundary and is zero-padded to a multiple of
+// 64 bytes (ORB/BRIEF 32 -> 64, AKAZE 61 -> 64, BRISK/FREAK 64, SIFT 512),
+// so distance kernels (descriptorDistance.hpp) use aligned full-width loads
+// with no tail; zero padding adds nothing to a Hamming or L2 distance. The
+// Mat is a view of the padded block: cols are the descriptor's own and
+// step[0] is the padded stride, so OpenCV code reads it like any other Mat.
+// ---------------------------------------------------------------------------
+constexpr size_t kDescriptorAlign = 64;
+
+inline size_t paddedRowBytes(size_t rowBytes)
+{
+    return (rowBytes + kDescriptorAlign - 1) / kDescriptorAlign * kDescriptorAlign;
+}
+
+// Arena-backed rows x cols matrix of `type` in the padded layout, padding zeroed.
+cv::Mat createPaddedDescriptors(int rows, int cols, int type);
+
+// Copy `packed` into the padded layout (packed and padded may be the same Mat).
+// Mats that already have it are passed through; empty ones stay empty.
+void padDescriptorRows(const cv::Mat &packed, cv::Mat &padded);
+
+// Float descriptors whose values are whole numbers in [0, 255] (OpenCV's
+// SIFT) to CV_8U in the padded layout: a quarter of the memory, matched with
+// the integer L2 kernel. Lossless for SIFT; other values are rounded and
+// saturated. floats and bytes may be the same Mat.
+void quantizeDescriptorRows(const cv::Mat &floats, cv::Mat &bytes);
+
+// True for an aligned base pointer and a stride of exactly the padded row
+// size. Assumes the bytes between cols and the stride are zero, which holds
+// for Mats made above (and for packed rows of 64 or 512 bytes, with none).
+bool hasPaddedRows(const cv::Mat &descriptors);
+
+#endif /* descriptorArena_hpp */
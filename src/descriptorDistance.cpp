@@ -0,0 +1,53 @@
+#include <cmath>
+
+#include "descriptorDistance.hpp"
+
+using namespace std;
+
+bool paddedKernelsApply(const cv::Mat &a, const cv::Mat &b, int normType)
+{
+    const bool typeOk = normType == cv::NORM_HAMMING ? a.type() == CV_8U
+                                                     : a.type() == CV_32F || a.type() == CV_8U;
+    return typeOk && a.type() == b.type() && a.cols == b.cols
+           && hasPaddedRows(a) && hasPaddedRows(b);
+}
+
+static float paddedDistance(const uchar *a, const uchar *b, size_t bytes, int normType, int type)
+{
+    if (normType == cv::NORM_HAMMING)
+        return (float)hammingPadded(a, b, bytes);
+    if (type == CV_8U)
+        return sqrt((float)l2SqrPadded(a, b, bytes));
+    return sqrt(l2SqrPadded(reinterpret_cast<const float *>(a),
+                            reinterpret_cast<const float *>(b), bytes / sizeof(float)));
+}
+
+float descriptorDistance(const cv::Mat &a, int i, const cv::Mat &b, int j, int normType)
+{
+    if (!paddedKernelsApply(a, b, normType))
+        return (float)cv::norm(a.row(i), b.row(j), normType);
+    return paddedDistance(a.ptr(i), b.ptr(j), a.step[0], normType, a.type());
+}
+
+void descriptorDistanceMatrix(const cv::Mat &query, const cv::Mat &train, int normType,
+                              cv::Mat &dist)
+{
+    if (!paddedKernelsApply(query, train, normType))
+    {
+        const bool binary = normType == cv::NORM_HAMMING;
+        cv::batchDistance(query, train, dist, binary ? CV_32S : CV_32F, cv::noArray(), normType);
+        if (binary)
+            dist.convertTo(dist, CV_32F);
+        return;
+    }
+
+    dist.create(query.rows, train.rows, CV_32F);
+    const size_t bytes = query.step[0];
+    for (int i = 0; i < query.rows; ++i)
+    {
+        const uchar *q = query.ptr(i);
+        float *out = dist.ptr<float>(i);
+        for (int j = 0; j < train.rows; ++j)
+            out[j] = paddedDistance(q, train.ptr(j), bytes, normType, query.type());
+    }
+}
@@ -0,0 +1,130 @@
+#ifndef descriptorDistance_hpp
+#define descriptorDistance_hpp
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+#if defined(__AVX2__)
+  #include <immintrin.h>
+#elif defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
+
+#include <opencv2/core.hpp>
+
+#include "descriptorArena.hpp"
+
+// ---------------------------------------------------------------------------
+// Distance kernels over padded descriptor rows (see padDescriptorRows): both
+// pointers 64-byte aligned, the length a whole number of 64-byte blocks and
+// the padding zero in both rows, so there is no tail to handle.
+// ---------------------------------------------------------------------------
+
+// Hamming distance of two binary rows, 64 bits at a time.
+inline int hammingPadded(const uint8_t *a, const uint8_t *b, size_t bytes)
+{
+    int d = 0;
+    for (size_t i = 0; i < bytes; i += 8)
+    {
+        uint64_t x, y;
+        memcpy(&x, a + i, 8);   // compiles to a plain load
+        memcpy(&y, b + i, 8);
+        d += __builtin_popcountll(x ^ y);
+    }
+    return d;
+}
+
+// Squared L2 distance of two float rows; n is a multiple of 16.
+inline float l2SqrPadded(const float *a, const float *b, size_t n)
+{
+#if defined(__SSE2__)
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+    for (size_t i = 0; i < n; i += 16)
+    {
+        const __m128 d0 = _mm_sub_ps(_mm_load_ps(a + i),      _mm_load_ps(b + i));
+        const __m128 d1 = _mm_sub_ps(_mm_load_ps(a + i + 4),  _mm_load_ps(b + i + 4));
+        const __m128 d2 = _mm_sub_ps(_mm_load_ps(a + i + 8),  _mm_load_ps(b + i + 8));
+        const __m128 d3 = _mm_sub_ps(_mm_load_ps(a + i + 12), _mm_load_ps(b + i + 12));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(d2, d2));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(d3, d3));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3)));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+    float s = 0.f;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const float d = a[i] - b[i];
+        s += d * d;
+    }
+    return s;
+#endif
+}
+
+// Squared L2 distance of two uint8 rows (quantized SIFT), exact in int32
+// (128 x 255^2 < 2^31). |a - b| comes from two saturating subtractions, is
+// widened to 16 bits and squared-and-summed with pmaddwd.
+inline int l2SqrPadded(const uint8_t *a, const uint8_t *b, size_t bytes)
+{
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero;
+    for (size_t i = 0; i < bytes; i += 32)
+    {
+        const __m256i va = _mm256_load_si256(reinterpret_cast<const __m256i *>(a + i));
+        const __m256i vb = _mm256_load_si256(reinterpret_cast<const __m256i *>(b + i));
+        const __m256i d  = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+        const __m256i lo = _mm256_unpacklo_epi8(d, zero), hi = _mm256_unpackhi_epi8(d, zero);
+        acc = _mm256_add_epi32(acc, _mm256_add_epi32(_mm256_madd_epi16(lo, lo),
+                                                     _mm256_madd_epi16(hi, hi)));
+    }
+    int lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (size_t i = 0; i < bytes; i += 16)
+    {
+        const __m128i va = _mm_load_si128(reinterpret_cast<const __m128i *>(a + i));
+        const __m128i vb = _mm_load_si128(reinterpret_cast<const __m128i *>(b + i));
+        const __m128i d  = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+        const __m128i lo = _mm_unpacklo_epi8(d, zero), hi = _mm_unpackhi_epi8(d, zero);
+        acc = _mm_add_epi32(acc, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+    }
+    int lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+    int s = 0;
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        const int d = (int)a[i] - (int)b[i];
+        s += d * d;
+    }
+    return s;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Matrix-level helpers. Both take the padded kernels when both sides have the
+// padded layout and the same type and width (CV_8U for Hamming, CV_32F or
+// quantized CV_8U for L2), and fall back to OpenCV otherwise. Distances are in cv::norm units: bit count or (unsquared) L2.
+// ---------------------------------------------------------------------------
+
+// Both sides padded, same type and width, and a type the kernels handle.
+bool paddedKernelsApply(const cv::Mat &a, const cv::Mat &b, int normType);
+
+// Distance between row i of a and row j of b.
+float descriptorDistance(const cv::Mat &a, int i, const cv::Mat &b, int j, int normType);
+
+// CV_32F query.rows x train.rows matrix of all pairwise distances.
+void descriptorDistanceMatrix(const cv::Mat &query, const cv::Mat &train, int normType,
+                              cv::Mat &dist);
+
+#endif /* descriptorDistance_hpp */
@@ -0,0 +1,77 @@
+#include <algorithm>
+
+#include "featureRegistry.hpp"
+
+using namespace std;
+
+FeatureRegistry &FeatureRegistry::instance()
+{
+    static FeatureRegistry *registry = [] {
+        FeatureRegistry *r = new FeatureRegistry();
+        registerBuiltinFeatures(*r);
+        return r;
+    }();
+    return *registry;
+}
+
+template <class Info>
+static const Info *findByName(const vector<Info> &entries, const string &name)
+{
+    auto it = find_if(entries.begin(), entries.end(),
+                      [&](const Info &e) { return e.name == name; });
+    return it == entries.end() ? nullptr : &*it;
+}
+
+void FeatureRegistry::addDetector(DetectorInfo info)
+{
+    if (findByName(detectors_, info.name))
+        throw invalid_argument("FeatureRegistry::addDetector: '" + info.name + "' is already registered");
+    detectors_.push_back(std::move(info));
+}
+
+void FeatureRegistry::addDescriptor(DescriptorInfo info)
+{
+    if (findByName(descriptors_, info.name))
+        throw invalid_argument("FeatureRegistry::addDescriptor: '" + info.name + "' is already registered");
+    descriptors_.push_back(std::move(info));
+}
+
+const DetectorInfo &FeatureRegistry::detector(const string &name) const
+{
+    const DetectorInfo *info = findByName(detectors_, name);
+    if (!info)
+        throw invalid_argument("FeatureRegistry: unknown detectorType '" + name + "'");
+    return *info;
+}
+
+const DescriptorInfo &FeatureRegistry::descriptor(const string &name) const
+{
+    const DescriptorInfo *info = findByName(descriptors_, name);
+    if (!info)
+        throw invalid_argument("FeatureRegistry: unknown descriptorType '" + name + "'");
+    return *info;
+}
+
+vector<string> FeatureRegistry::detectorNames() const
+{
+    vector<string> names;
+    for (const auto &d : detectors_)
+        if (d.available)
+            names.push_back(d.name);
+    return names;
+}
+
+vector<string> FeatureRegistry::descriptorNames() const
+{
+    vector<string> names;
+    for (const auto &d : descriptors_)
+        if (d.available)
+            names.push_back(d.name);
+    return names;
+}
+
+bool FeatureRegistry::compatible(const string &detectorName, const string &descriptorName) const
+{
+    const DescriptorInfo &desc = descriptor(descriptorName);
+    return desc.requiresDetector.empty() || desc.requiresDetector == detectorName;
+}
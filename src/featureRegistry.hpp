@@ -0,0 +1,128 @@
+#ifndef featureRegistry_hpp
+#define featureRegistry_hpp
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <variant>
+#include <stdexcept>
+
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+// ---------------------------------------------------------------------------
+// Detection kernels. Built-in kernels are concrete types so KeypointDetector
+// reaches them through std::visit without a virtual call; OpenCV algorithms
+// and plug-ins registered at runtime use the last two alternatives.
+// ---------------------------------------------------------------------------
+struct ShiTomasiKernel
+{
+    void detect(const cv::Mat &img, std::vector<cv::KeyPoint> &keypoints) const;
+};
+
+struct HarrisKernel
+{
+    void detect(const cv::Mat &img, std::vector<cv::KeyPoint> &keypoints) const;
+};
+
+struct OpenCvDetectorKernel
+{
+    cv::Ptr<cv::Feature2D> algorithm;
+    void detect(const cv::Mat &img, std::vector<cv::KeyPoint> &keypoints) const
+    {
+        algorithm->detect(img, keypoints);
+    }
+};
+
+struct FunctionDetectorKernel
+{
+    std::function<void(const cv::Mat &, std::vector<cv::KeyPoint> &)> fn;
+    void detect(const cv::Mat &img, std::vector<cv::KeyPoint> &keypoints) const
+    {
+        fn(img, keypoints);
+    }
+};
+
+using DetectorKernel = std::variant<ShiTomasiKernel, HarrisKernel,
+                                    OpenCvDetectorKernel, FunctionDetectorKernel>;
+
+// ---------------------------------------------------------------------------
+// Registry entries
+// ---------------------------------------------------------------------------
+
+// Detection threshold a controller may move between frames (see
+// ThresholdController). Left at its defaults for fixed-threshold detectors.
+struct ThresholdRange
+{
+    double initial  = 0.0;                  // value baked into params / create()
+    double min      = 0.0;
+    double max      = 0.0;
+    bool   integral = false;                // FAST / BRISK take integer thresholds
+
+    bool adjustable() const { return max > min; }
+};
+
+struct DetectorInfo
+{
+    std::string name;                       // CLI name, upper case (e.g. "FAST")
+    std::string params;                     // fixed parameters; part of cache keys
+    std::function<DetectorKernel()> create; // may throw std::runtime_error
+    bool available = true;                  // false if built without its module
+
+    ThresholdRange threshold;               // adjustable detectors only
+    std::function<DetectorKernel(double)> createWithThreshold;
+};
+
+struct DescriptorInfo
+{
+    std::string name;
+    std::string params;
+    std::function<cv::Ptr<cv::Feature2D>()> create;
+    int  normType = cv::NORM_HAMMING;       // NORM_HAMMING (binary) or NORM_L2 (float)
+    std::string requiresDetector;           // non-empty: only valid on this detector's keypoints
+    bool available = true;
+    bool fusable = false;                   // same algorithm as the same-named detector, so
+                                            // one detectAndCompute pass can replace both
+    bool maskable = false;                  // fused detection under an ROI mask keeps the same
+                                            // points as filtering afterwards (threshold-based,
+                                            // not ORB's best-N over the frame)
+};
+
+// ---------------------------------------------------------------------------
+// Name -> algorithm registry. The built-in detectors and descriptors are
+// registered on first use; experiments add their own with addDetector /
+// addDescriptor before the pipeline is built. Registration is not
+// thread-safe, lookups are.
+// ---------------------------------------------------------------------------
+class FeatureRegistry
+{
+  public:
+    static FeatureRegistry &instance();
+
+    // Throw std::invalid_argument if the name is already registered.
+    void addDetector(DetectorInfo info);
+    void addDescriptor(DescriptorInfo info);
+
+    // Throw std::invalid_argument on unknown names.
+    const DetectorInfo   &detector(const std::string &name) const;
+    const DescriptorInfo &descriptor(const std::string &name) const;
+
+    // Available entries, in registration order (the default sweep order).
+    std::vector<std::string> detectorNames() const;
+    std::vector<std::string> descriptorNames() const;
+
+    // False when the descriptor is tied to a different detector.
+    bool compatible(const std::string &detector, const std::string &descriptor) const;
+
+  private:
+    FeatureRegistry() = default;
+
+    std::vector<DetectorInfo>   detectors_;
+    std::vector<DescriptorInfo> descriptors_;
+};
+
+// Registers SHITOMASI, HARRIS, FAST, BRISK, ORB, AKAZE, SIFT and the BRISK,
+// ORB, AKAZE, SIFT, BRIEF, FREAK descriptors (defined in matching2D.cpp).
+void registerBuiltinFeatures(FeatureRegistry &registry);
+
+#endif /* featureRegistry_hpp */
@@ -0,0 +1,297 @@
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <limits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "frameDump.hpp"
+#include "binaryLog.hpp"   // setName
+
+using namespace std;
+
+static const char kFrameDumpMagic[8] = {'F', 'T', 'D', 'U', 'M', 'P', 'v', '1'};
+static const char kFrameChunkMagic[4] = {'F', 'R', 'A', 'M'};
+static const uint32_t kFrameDumpVersion = 1;
+
+// ---------------------------------------------------------------------------
+// FrameDumpWriter
+// ---------------------------------------------------------------------------
+FrameDumpWriter::FrameDumpWriter(const string &path, size_t queueCapacity)
+    : out_(path, ios::binary | ios::trunc), queueCapacity_(max<size_t>(1, queueCapacity))
+{
+    if (!out_)
+        throw runtime_error("FrameDumpWriter: could not open '" + path + "' for writing");
+
+    FrameDumpHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, kFrameDumpMagic, sizeof(hdr.magic));
+    hdr.version = kFrameDumpVersion;
+    out_.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+
+    thread_ = thread(&FrameDumpWriter::writerLoop, this);
+}
+
+FrameDumpWriter::~FrameDumpWriter()
+{
+    close();
+}
+
+void FrameDumpWriter::close()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    notEmpty_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+    out_.flush();
+}
+
+void FrameDumpWriter::submit(FrameDumpJob job)
+{
+    unique_lock<mutex> lock(mutex_);
+    notFull_.wait(lock, [this] { return queue_.size() < queueCapacity_; });
+    queue_.push_back(std::move(job));
+    lock.unlock();
+    notEmpty_.notify_one();
+}
+
+void FrameDumpWriter::writerLoop()
+{
+    for (;;)
+    {
+        FrameDumpJob job;
+        {
+            unique_lock<mutex> lock(mutex_);
+            notEmpty_.wait(lock, [this] { return !queue_.empty() || stopping_; });
+            if (queue_.empty())
+                return; // stopping and drained
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        notFull_.notify_one();
+        writeFrame(job);
+    }
+}
+
+// Zero-pad a block of `bytes` up to the next 64-byte boundary.
+static void writePadding(ofstream &out, size_t bytes)
+{
+    static const char zeros[64] = {0};
+    out.write(zeros, (streamsize)(dumpAlign(bytes) - bytes));
+}
+
+static void writeBlock(ofstream &out, const void *data, size_t bytes)
+{
+    if (bytes)
+        out.write(static_cast<const char *>(data), (streamsize)bytes);
+    writePadding(out, bytes);
+}
+
+void FrameDumpWriter::writeFrame(const FrameDumpJob &job)
+{
+    const cv::Mat &desc = job.descriptors;
+    if (!desc.empty() && (size_t)desc.rows != job.keypoints.size())
+    {
+        cerr << "[WARN] FrameDumpWriter: frame " << job.imageIndex
+             << " has " << desc.rows << " descriptors for " << job.keypoints.size()
+             << " keypoints; skipped\n";
+        return;
+    }
+
+    const size_t rowBytes = desc.empty() ? 0 : (size_t)desc.cols * desc.elemSize();
+    const size_t kptBytes = job.keypoints.size() * sizeof(DumpKeyPoint);
+    const size_t dscBytes = job.keypoints.size() * rowBytes;
+    const size_t matBytes = job.matches.size() * sizeof(DumpMatch);
+
+    FrameDumpChunk chunk;
+    memset(&chunk, 0, sizeof(chunk));
+    memcpy(chunk.magic, kFrameChunkMagic, sizeof(chunk.magic));
+    chunk.chunkBytes   = (uint32_t)(sizeof(chunk) + dumpAlign(kptBytes)
+                                    + dumpAlign(dscBytes) + dumpAlign(matBytes));
+    chunk.imageIndex   = job.imageIndex;
+    chunk.numKeypoints = (uint32_t)job.keypoints.size();
+    chunk.numMatches   = (uint32_t)job.matches.size();
+    chunk.descType     = desc.empty() ? -1 : desc.type();
+    chunk.descCols     = (uint32_t)desc.cols;
+    chunk.descRowBytes = (uint32_t)rowBytes;
+    setName(chunk.detectorType, job.detectorType);
+    setName(chunk.descriptorType, job.descriptorType);
+    out_.write(reinterpret_cast<const char *>(&chunk), sizeof(chunk));
+
+    vector<DumpKeyPoint> kpts(job.keypoints.size());
+    for (size_t i = 0; i < kpts.size(); ++i)
+    {
+        const cv::KeyPoint &kp = job.keypoints[i];
+        kpts[i] = {kp.pt.x, kp.pt.y, kp.size, kp.angle, kp.response, kp.octave, kp.class_id};
+    }
+    writeBlock(out_, kpts.data(), kptBytes);
+
+    // Descriptor rows are written tightly packed even if the Mat has a stride.
+    if (desc.isContinuous())
+    {
+        writeBlock(out_, desc.ptr(), dscBytes);
+    }
+    else
+    {
+        for (int r = 0; r < desc.rows; ++r)
+            out_.write(reinterpret_cast<const char *>(desc.ptr(r)), (streamsize)rowBytes);
+        writePadding(out_, dscBytes);
+    }
+
+    vector<DumpMatch> matches(job.matches.size());
+    for (size_t i = 0; i < matches.size(); ++i)
+        matches[i] = {job.matches[i].queryIdx, job.matches[i].trainIdx, job.matches[i].distance};
+    writeBlock(out_, matches.data(), matBytes);
+
+    ++framesWritten_;
+}
+
+// ---------------------------------------------------------------------------
+// FrameDumpReader
+// ---------------------------------------------------------------------------
+// Sizes are summed in size_t and capped well below its range, so dumpAlign()
+// and the running total cannot wrap.
+static bool addBlock(size_t &total, size_t count, size_t elemBytes)
+{
+    const size_t limit = numeric_limits<size_t>::max() / 4;
+    if (elemBytes != 0 && count > limit / elemBytes)
+        return false;
+    const size_t bytes = dumpAlign(count * elemBytes);
+    if (bytes > limit - total)
+        return false;
+    total += bytes;
+    return true;
+}
+
+// The blocks described by the counts must lie inside chunkBytes; block() and
+// the accessors trust them afterwards.
+static bool chunkLayoutValid(const FrameDumpChunk &c)
+{
+    // A row must hold descCols elements; the product fits 64 bits for any type.
+    if (c.descType >= 0 && (uint64_t)c.descRowBytes < (uint64_t)c.descCols * CV_ELEM_SIZE(c.descType))
+        return false;
+    size_t total = sizeof(FrameDumpChunk);
+    return addBlock(total, c.numKeypoints, sizeof(DumpKeyPoint))
+        && addBlock(total, c.numKeypoints, c.descRowBytes)
+        && addBlock(total, c.numMatches, sizeof(DumpMatch))
+        && total <= c.chunkBytes;
+}
+
+FrameDumpReader::FrameDumpReader(const string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw runtime_error("FrameDumpReader: could not open '" + path + "': " + strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FrameDumpHeader))
+    {
+        ::close(fd);
+        throw runtime_error("FrameDumpReader: '" + path + "' is too short to be a dump");
+    }
+    bytes_ = (size_t)st.st_size;
+    base_  = mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (base_ == MAP_FAILED)
+    {
+        base_ = nullptr;
+        throw runtime_error("FrameDumpReader: mmap failed: " + string(strerror(errno)));
+    }
+
+    const uint8_t *p = static_cast<const uint8_t *>(base_);
+    const FrameDumpHeader *hdr = reinterpret_cast<const FrameDumpHeader *>(p);
+    if (memcmp(hdr->magic, kFrameDumpMagic, sizeof(hdr->magic)) != 0
+        || hdr->version != kFrameDumpVersion)
+    {
+        munmap(base_, bytes_);
+        throw runtime_error("FrameDumpReader: '" + path + "' is not a version "
+                            + to_string(kFrameDumpVersion) + " frame dump");
+    }
+
+    // Walk the chunk headers once; a truncated trailing chunk (writer killed
+    // mid-frame) is ignored rather than rejected.
+    size_t offset = sizeof(FrameDumpHeader);
+    while (offset + sizeof(FrameDumpChunk) <= bytes_)
+    {
+        const FrameDumpChunk *c = reinterpret_cast<const FrameDumpChunk *>(p + offset);
+        if (memcmp(c->magic, kFrameChunkMagic, sizeof(c->magic)) != 0 || c->chunkBytes < sizeof(*c))
+        {
+            munmap(base_, bytes_);
+            throw runtime_error("FrameDumpReader: corrupt chunk at offset " + to_string(offset));
+        }
+        if (!chunkLayoutValid(*c))
+        {
+            munmap(base_, bytes_);
+            throw runtime_error("FrameDumpReader: chunk at offset " + to_string(offset)
+                                + " has counts that do not fit its size");
+        }
+        if (offset + c->chunkBytes > bytes_)
+            break;
+        chunks_.push_back(c);
+        offset += c->chunkBytes;
+    }
+}
+
+FrameDumpReader::~FrameDumpReader()
+{
+    if (base_)
+        munmap(base_, bytes_);
+}
+
+// which: 0 = keypoints, 1 = descriptors, 2 = matches
+const uint8_t *FrameDumpReader::block(size_t i, size_t which) const
+{
+    const FrameDumpChunk &c = *chunks_[i];
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(&c) + sizeof(FrameDumpChunk);
+    if (which > 0) p += dumpAlign((size_t)c.numKeypoints * sizeof(DumpKeyPoint));
+    if (which > 1) p += dumpAlign((size_t)c.numKeypoints * c.descRowBytes);
+    return p;
+}
+
+static string fieldToString(const char *field, size_t n)
+{
+    return string(field, strnlen(field, n));
+}
+
+string FrameDumpReader::detectorType(size_t i) const
+{
+    return fieldToString(chunks_[i]->detectorType, sizeof(chunks_[i]->detectorType));
+}
+
+string FrameDumpReader::descriptorType(size_t i) const
+{
+    return fieldToString(chunks_[i]->descriptorType, sizeof(chunks_[i]->descriptorType));
+}
+
+vector<cv::KeyPoint> FrameDumpReader::keypoints(size_t i) const
+{
+    const DumpKeyPoint *src = reinterpret_cast<const DumpKeyPoint *>(block(i, 0));
+    vector<cv::KeyPoint> kpts(chunks_[i]->numKeypoints);
+    for (size_t k = 0; k < kpts.size(); ++k)
+        kpts[k] = cv::KeyPoint(src[k].x, src[k].y, src[k].size, src[k].angle,
+                               src[k].response, src[k].octave, src[k].classId);
+    return kpts;
+}
+
+cv::Mat FrameDumpReader::descriptors(size_t i) const
+{
+    const FrameDumpChunk &c = *chunks_[i];
+    if (c.descType < 0 || c.numKeypoints == 0)
+        return cv::Mat();
+    // The mapping is read-only; matchers only read their inputs.
+    return cv::Mat((int)c.numKeypoints, (int)c.descCols, c.descType,
+                   const_cast<uint8_t *>(block(i, 1)), c.descRowBytes);
+}
+
+vector<cv::DMatch> FrameDumpReader::matches(size_t i) const
+{
+    const DumpMatch *src = reinterpret_cast<const DumpMatch *>(block(i, 2));
+    vector<cv::DMatch> out(chunks_[i]->numMatches);
+    for (size_t k = 0; k < out.size(); ++k)
+        out[k] = cv::DMatch(src[k].queryIdx, src[k].trainIdx, src[k].distance);
+    return out;
+}
@@ -0,0 +1,142 @@
+#ifndef frameDump_hpp
+#define frameDump_hpp
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <stdexcept>
+
+#include <opencv2/core.hpp>
+
+// ---------------------------------------------------------------------------
+// Full per-frame dump of keypoints, descriptors and matches, for replaying
+// matching experiments offline.
+//
+// File layout (little-endian, every block starts on a 64-byte boundary so
+// the descriptor block can be used in place from a memory map):
+//   FrameDumpHeader                                  64 bytes
+//   per frame:
+//     FrameDumpChunk                                 64 bytes
+//     DumpKeyPoint x numKeypoints                    padded to 64
+//     descriptor rows x numKeypoints (descRowBytes)  padded to 64
+//     DumpMatch x numMatches                         padded to 64
+// ---------------------------------------------------------------------------
+
+struct FrameDumpHeader
+{
+    char     magic[8];    // "FTDUMPv1"
+    uint32_t version;
+    char     reserved[52];
+};
+static_assert(sizeof(FrameDumpHeader) == 64, "FrameDumpHeader layout is part of the file format");
+
+struct FrameDumpChunk
+{
+    char     magic[4];     // "FRAM"
+    uint32_t chunkBytes;   // whole chunk including padding
+    uint32_t imageIndex;
+    uint32_t numKeypoints;
+    uint32_t numMatches;   // matches against the previous frame of the same combination
+    int32_t  descType;     // OpenCV type of the descriptor matrix (CV_8U / CV_32F)
+    uint32_t descCols;
+    uint32_t descRowBytes;
+    char     detectorType[16];
+    char     descriptorType[16];
+};
+static_assert(sizeof(FrameDumpChunk) == 64, "FrameDumpChunk layout is part of the file format");
+
+struct DumpKeyPoint
+{
+    float   x, y, size, angle, response;
+    int32_t octave, classId;
+};
+
+struct DumpMatch
+{
+    int32_t queryIdx, trainIdx;
+    float   distance;
+};
+
+// Round up to the 64-byte block alignment used throughout the dump.
+inline size_t dumpAlign(size_t n) { return (n + 63) & ~size_t(63); }
+
+// One frame's worth of pipeline output, queued for the background writer.
+struct FrameDumpJob
+{
+    uint32_t imageIndex = 0;
+    std::string detectorType, descriptorType;
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat descriptors;               // shared, never modified after description
+    std::vector<cv::DMatch> matches;
+};
+
+// Serialises FrameDumpJobs to disk on a background thread. The queue is
+// bounded and submit() blocks when it is full: a dump is only useful for
+// replay if it is complete. The destructor writes out everything queued.
+class FrameDumpWriter
+{
+  public:
+    // Truncates `path`. Throws std::runtime_error if it cannot be opened.
+    explicit FrameDumpWriter(const std::string &path, size_t queueCapacity = 16);
+    ~FrameDumpWriter();
+
+    FrameDumpWriter(const FrameDumpWriter &) = delete;
+    FrameDumpWriter &operator=(const FrameDumpWriter &) = delete;
+
+    void submit(FrameDumpJob job);
+
+    // Write out all queued frames and stop the writer thread.
+    void close();
+
+    size_t framesWritten() const { return framesWritten_; }
+
+  private:
+    void writerLoop();
+    void writeFrame(const FrameDumpJob &job);
+
+    std::ofstream out_;
+    size_t queueCapacity_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_, notFull_;
+    std::deque<FrameDumpJob> queue_;
+    bool stopping_ = false;
+    std::thread thread_;
+    size_t framesWritten_ = 0;  // only touched by the writer thread until close()
+};
+
+// Read-only, memory-mapped view of a dump written by FrameDumpWriter.
+// Descriptor matrices returned by descriptors() point into the mapping and
+// stay valid for the lifetime of the reader.
+class FrameDumpReader
+{
+  public:
+    // Throws std::runtime_error if the file cannot be mapped or is malformed.
+    explicit FrameDumpReader(const std::string &path);
+    ~FrameDumpReader();
+
+    FrameDumpReader(const FrameDumpReader &) = delete;
+    FrameDumpReader &operator=(const FrameDumpReader &) = delete;
+
+    size_t size() const { return chunks_.size(); }
+    const FrameDumpChunk &chunk(size_t i) const { return *chunks_[i]; }
+
+    std::string detectorType(size_t i) const;
+    std::string descriptorType(size_t i) const;
+    std::vector<cv::KeyPoint> keypoints(size_t i) const;
+    cv::Mat descriptors(size_t i) const;     // zero-copy header over the mapping
+    std::vector<cv::DMatch> matches(size_t i) const;
+
+  private:
+    const uint8_t *block(size_t i, size_t which) const;
+
+    void *base_ = nullptr;
+    size_t bytes_ = 0;
+    std::vector<const FrameDumpChunk *> chunks_;
+};
+
+#endif /* frameDump_hpp */
@@ -0,0 +1,418 @@
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+
+#include "framePipeline.hpp"
+#include "asyncImageWriter.hpp"
+#include "binaryLog.hpp"
+#include "descriptorArena.hpp"
+#include "frameDump.hpp"
+#include "resultCache.hpp"
+
+using namespace std;
+
+// ---------------------------------------------------------------------------
+// Restrict keypoints to the vehicle ROI and apply the budget.
+// ---------------------------------------------------------------------------
+static void filterKeypoints(const cv::Size &imgSize, vector<cv::KeyPoint> &keypoints,
+                            bool bFocusOnVehicle, const KeypointBudget &budget)
+{
+    if (bFocusOnVehicle)
+    {
+        // Erase-remove idiom -- O(n) instead of the O(n^2) manual-erase loop.
+        keypoints.erase(
+            remove_if(keypoints.begin(), keypoints.end(),
+                      [](const cv::KeyPoint &kp){ return !kVehicleROI.contains(kp.pt); }),
+            keypoints.end());
+    }
+
+    if (budget.enabled())
+    {
+        const size_t detected = keypoints.size();
+        retainBestKeypoints(keypoints, budget,
+                            bFocusOnVehicle ? kVehicleROI : cv::Rect(0, 0, imgSize.width, imgSize.height));
+        if (keypoints.size() < detected)
+            cout << "Keypoint budget kept " << keypoints.size() << " of " << detected << "\n";
+    }
+}
+
+static void detectAndFilterKeypoints(const cv::Mat &img,
+                                     const KeypointDetector &detector,
+                                     vector<cv::KeyPoint> &keypoints,
+                                     bool bFocusOnVehicle,
+                                     const KeypointBudget &budget)
+{
+    detector.detect(img, keypoints);
+    filterKeypoints(img.size(), keypoints, bFocusOnVehicle, budget);
+}
+
+// Fused path: detect and describe in one pass, then keep the descriptor rows
+// of the keypoints that survive filtering (same order as the separate path).
+// With an ROI mask only ROI keypoints are described in the first place; the
+// ROI filter still runs to drop points on the mask's boundary pixels.
+static void detectDescribeAndFilter(const cv::Mat &img,
+                                    const cv::Mat &roiMask,
+                                    const KeypointDescriber &describer,
+                                    vector<cv::KeyPoint> &keypoints,
+                                    cv::Mat &descriptors,
+                                    bool bFocusOnVehicle,
+                                    const KeypointBudget &budget)
+{
+    vector<cv::KeyPoint> all;
+    cv::Mat allDescriptors;
+    describer.detectAndDescribe(img, roiMask, all, allDescriptors);
+
+    // Tag each keypoint with its descriptor row while filtering reorders them.
+    keypoints = all;
+    for (size_t i = 0; i < keypoints.size(); ++i)
+        keypoints[i].class_id = (int)i;
+    filterKeypoints(img.size(), keypoints, bFocusOnVehicle, budget);
+
+    // Compact the surviving rows straight into the padded arena layout.
+    descriptors = createPaddedDescriptors((int)keypoints.size(), allDescriptors.cols,
+                                          allDescriptors.type());
+    const size_t rowBytes = (size_t)allDescriptors.cols * allDescriptors.elemSize();
+    for (size_t i = 0; i < keypoints.size(); ++i)
+    {
+        const int row = keypoints[i].class_id;
+        keypoints[i] = all[row];   // restores class_id (AKAZE keeps scale data there)
+        memcpy(descriptors.ptr((int)i), allDescriptors.ptr(row), rowBytes);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Log per-frame keypoint statistics (uses '\n', not std::endl).
+// ---------------------------------------------------------------------------
+static void logKeypointStats(const PipelineOutputs &outputs, size_t imgIndex,
+                             const string &detectorType,
+                             const vector<cv::KeyPoint> &keypoints,
+                             double detectMs)
+{
+    float minSz = numeric_limits<float>::max(), maxSz = 0.f, meanSz = 0.f;
+    for (const auto &kp : keypoints)
+    {
+        minSz  = min(minSz,  kp.size);
+        maxSz  = max(maxSz,  kp.size);
+        meanSz += kp.size;
+    }
+    if (!keypoints.empty())  meanSz /= (float)keypoints.size();
+    else                     minSz  = 0.f;
+
+    if (outputs.keypointLog)
+        *outputs.keypointLog << imgIndex << "," << detectorType << "," << keypoints.size()
+                             << "," << minSz << "," << maxSz << "," << meanSz << "\n"; // #11
+
+    if (outputs.keypointBinLog)
+    {
+        KeypointLogRecord rec;
+        rec.imageIndex = (uint32_t)imgIndex;
+        setName(rec.detectorType, detectorType);
+        rec.numKeypoints = (uint32_t)keypoints.size();
+        rec.minSize  = minSz;
+        rec.maxSize  = maxSz;
+        rec.meanSize = meanSz;
+        rec.detectMs = (float)detectMs;
+        outputs.keypointBinLog->append(rec);
+    }
+    if (outputs.keypointDump)
+    {
+        vector<KeypointDumpRecord> recs(keypoints.size());
+        for (size_t i = 0; i < keypoints.size(); ++i)
+        {
+            const cv::KeyPoint &kp = keypoints[i];
+            KeypointDumpRecord &rec = recs[i];
+            rec.imageIndex = (uint32_t)imgIndex;
+            setName(rec.detectorType, detectorType);
+            rec.x = kp.pt.x;  rec.y = kp.pt.y;
+            rec.size = kp.size;  rec.angle = kp.angle;  rec.response = kp.response;
+            rec.octave = kp.octave;
+        }
+        outputs.keypointDump->append(recs);
+    }
+
+    cout << "Image " << imgIndex << " - " << detectorType << ": "
+         << keypoints.size() << " keypoints"
+         << "  (Min: " << minSz << "  Max: " << maxSz << "  Mean: " << meanSz << ")\n";
+}
+
+// ---------------------------------------------------------------------------
+// Match CSV row plus binary match rows (--binlog / --binlog-matches).
+// ---------------------------------------------------------------------------
+void logMatches(const PipelineOutputs &outputs, size_t imgIndex,
+                const string &detectorType,
+                const string &descriptorType,
+                const vector<cv::DMatch> &matches,
+                double matchMs)
+{
+    if (outputs.matchLog)
+        *outputs.matchLog << imgIndex << "," << detectorType << ","    // #11
+                          << descriptorType << "," << matches.size() << "\n";
+    if (outputs.matchBinLog)
+    {
+        MatchLogRecord rec;
+        rec.imageIndex = (uint32_t)imgIndex;
+        setName(rec.detectorType, detectorType);
+        setName(rec.descriptorType, descriptorType);
+        rec.numMatches = (uint32_t)matches.size();
+        rec.matchMs    = (float)matchMs;
+        outputs.matchBinLog->append(rec);
+    }
+    if (outputs.matchDump)
+    {
+        vector<MatchDumpRecord> recs(matches.size());
+        for (size_t i = 0; i < matches.size(); ++i)
+        {
+            MatchDumpRecord &rec = recs[i];
+            rec.imageIndex = (uint32_t)imgIndex;
+            setName(rec.detectorType, detectorType);
+            setName(rec.descriptorType, descriptorType);
+            rec.queryIdx = matches[i].queryIdx;
+            rec.trainIdx = matches[i].trainIdx;
+            rec.distance = matches[i].distance;
+        }
+        outputs.matchDump->append(recs);
+    }
+}
+
+void logMatchStats(const MatchStats &stats)
+{
+    cout << "    search " << stats.candidates << " (" << stats.searchMs << " ms)"
+         << " -> ratio " << stats.afterRatio
+         << " -> mutual " << stats.afterMutual
+         << " -> max-dist " << stats.survivors
+         << " (filter " << stats.filterMs << " ms)\n";
+    if (stats.recall >= 0.0)
+        cout << "    hash recall " << 100.0 * stats.recall << " % of MAT_BF top-1"
+             << " (MAT_BF search " << stats.exactMs << " ms)\n";
+}
+
+// ---------------------------------------------------------------------------
+// FramePipeline
+// ---------------------------------------------------------------------------
+static FrameMatcher makeMatcher(const PipelineSettings &settings, bool binary)
+{
+    const MatcherKind  kind     = parseMatcherKind(settings.matcherType);
+    const SelectorKind selector = parseSelectorKind(settings.selectorType);
+    if (settings.bParallelMatch)
+        return FrameMatcher(kind, selector, binary, settings.matchConfig);
+    return FrameMatcher(kind, selector, binary, settings.matchConfig, nullptr);
+}
+
+PipelineStages::PipelineStages(const DetectorInfo &det, const DescriptorInfo &desc,
+                               const PipelineSettings &settings)
+    : detector(det), describer(desc),
+      matcher(makeMatcher(settings, describer.isBinary())),
+      fused(settings.bFuseDetectDescribe && desc.fusable
+            && det.name == desc.name && det.params == desc.params),
+      masked(fused && desc.maskable && settings.bFocusOnVehicle)
+{
+}
+
+FramePipeline::FramePipeline(const string &detectorType, const string &descriptorType,
+                             const PipelineSettings &settings, const PipelineOutputs &outputs)
+    : settings_(settings),
+      stages_(FeatureRegistry::instance().detector(detectorType),
+              FeatureRegistry::instance().descriptor(descriptorType), settings),
+      thresholdController_(settings.thresholdControl, stages_.detector.thresholdRange()),
+      outputs_(outputs)
+{
+    // A controlled threshold only reaches the detector, not the describer's copy.
+    if (thresholdController_.active())
+        stages_.fused = stages_.masked = false;
+
+    // With a budget the largest descriptor matrix is known: have one arena
+    // block per buffered frame ready, plus the one being filled.
+    size_t rowBytes = stages_.describer.rowBytes();
+    if (settings_.bQuantizeDescriptors && !stages_.describer.isBinary())
+        rowBytes /= sizeof(float);
+    if (settings_.keypointBudget.enabled())
+        DescriptorArena::instance().reserve(
+            settings_.keypointBudget.maxKeypoints * paddedRowBytes(rowBytes),
+            (size_t)settings_.dataBufferSize + 1);
+}
+
+FrameResult FramePipeline::process(const cv::Mat &imgGray, size_t imgIndex,
+                                   const FrameShortcuts &shortcuts)
+{
+    const string &detectorType   = stages_.detector.name();
+    const string &descriptorType = stages_.describer.name();
+    FrameResult result;
+
+    /* --- 2. Ring buffer (O(1) pop_front) --- */  // Deque gives O(1) pop_front
+    DataFrame frame;
+    frame.cameraImg = imgGray;
+    if ((int)dataBuffer_.size() == settings_.dataBufferSize)
+        dataBuffer_.pop_front();
+    dataBuffer_.push_back(frame);
+
+    cout << "#1 : LOAD IMAGE INTO BUFFER done" << endl;
+
+    /* --- 3. Detect & filter keypoints (or reuse a cached / previous result) --- */
+    KeypointBudget budget = settings_.keypointBudget;
+    if (shortcuts.maxKeypoints > 0 && (!budget.enabled() || shortcuts.maxKeypoints < budget.maxKeypoints))
+        budget.maxKeypoints = shortcuts.maxKeypoints;
+    const bool reuseKeypoints = shortcuts.reuseKeypoints && dataBuffer_.size() > 1;
+
+    double t = (double)cv::getTickCount();
+    vector<cv::KeyPoint> keypoints;
+    cv::Mat fusedDescriptors;
+    bool fused = false;             // descriptors came out of detection
+    string detectionKey;
+    bool detectionCached = false;
+    if (reuseKeypoints)
+    {
+        keypoints = dataBuffer_[dataBuffer_.size() - 2].keypoints;
+        if (budget.enabled())
+            retainBestKeypoints(keypoints, budget, settings_.bFocusOnVehicle
+                                ? kVehicleROI : cv::Rect(0, 0, imgGray.cols, imgGray.rows));
+    }
+    else
+    {
+        if (outputs_.cache)
+        {
+            // Anything that changes the detection output must be part of its key;
+            // the controlled threshold drifts from the one in the params tag.
+            string params = stages_.detector.paramsTag();
+            if (budget.enabled())
+                params += ";budget=" + to_string(budget.maxKeypoints)
+                          + ";grid=" + to_string(budget.gridCols) + "x" + to_string(budget.gridRows);
+            if (thresholdController_.active())
+                params += ";thrNow=" + to_string(stages_.detector.threshold());
+            // Only maskable detectors see the mask, and they keep the same
+            // points; the tag just keeps the two paths' entries apart.
+            if (stages_.masked)
+                params += ";roiMask";
+            detectionKey = outputs_.cache->detectionKey(
+                dataBuffer_.back().cameraImg, detectorType, params,
+                settings_.bFocusOnVehicle ? kVehicleROI : cv::Rect());
+            detectionCached = outputs_.cache->loadKeypoints(detectionKey, keypoints);
+        }
+        if (!detectionCached)
+        {
+            fused = stages_.fused;
+            // Built on the first frame; rebuilt if the frame size changes.
+            if (stages_.masked && roiMask_.size() != imgGray.size())
+            {
+                roiMask_ = cv::Mat::zeros(imgGray.size(), CV_8U);
+                roiMask_(kVehicleROI & cv::Rect(0, 0, imgGray.cols, imgGray.rows)).setTo(255);
+            }
+            if (fused)
+                detectDescribeAndFilter(dataBuffer_.back().cameraImg,
+                                        stages_.masked ? roiMask_ : cv::Mat(),
+                                        stages_.describer, keypoints, fusedDescriptors,
+                                        settings_.bFocusOnVehicle, budget);
+            else
+                detectAndFilterKeypoints(dataBuffer_.back().cameraImg, stages_.detector, keypoints,
+                                         settings_.bFocusOnVehicle, budget);
+            if (outputs_.cache)
+                outputs_.cache->storeKeypoints(detectionKey, keypoints);
+        }
+    }
+    result.detectMs     = elapsedMs(t);
+    result.numKeypoints = keypoints.size();
+    logKeypointStats(outputs_, imgIndex, detectorType, keypoints, result.detectMs);
+    dataBuffer_.back().keypoints = keypoints;
+    cout << "#2 : DETECT KEYPOINTS done"
+         << (reuseKeypoints ? " (previous frame's)" : detectionCached ? " (cached)"
+             : fused ? " (fused with extraction)" : "") << endl;
+
+    // Steer the next frame's threshold towards the target count. Cached frames
+    // feed the controller too, so a cached re-run follows the same thresholds.
+    // Frames cut short by a scheduler say nothing about the threshold.
+    const bool shortcut = reuseKeypoints || budget.maxKeypoints != settings_.keypointBudget.maxKeypoints;
+    if (thresholdController_.active() && !shortcut)
+    {
+        const double current = stages_.detector.threshold();
+        const double next    = thresholdController_.next(current, keypoints.size());
+        if (next != current)
+        {
+            stages_.detector.setThreshold(next);
+            cout << detectorType << " threshold " << current << " -> " << next << " ("
+                 << keypoints.size() << " keypoints, target "
+                 << settings_.thresholdControl.targetKeypoints << ")\n";
+        }
+    }
+
+    /* --- 4. Extract descriptors (or reuse a cached / fused result) --- */
+    t = (double)cv::getTickCount();
+    cv::Mat descriptors;
+    descriptors.allocator = &DescriptorArena::instance();   // cache loads land in the arena too
+    string descriptionKey;
+    bool descriptionCached = false;
+    if (outputs_.cache && !reuseKeypoints)
+        descriptionKey = outputs_.cache->descriptionKey(
+            detectionKey, descriptorType, stages_.describer.paramsTag());
+    if (fused)
+        descriptors = fusedDescriptors;
+    else if (outputs_.cache && !reuseKeypoints)
+        descriptionCached = outputs_.cache->loadDescriptors(
+            descriptionKey, dataBuffer_.back().keypoints, descriptors);
+    if (!fused && !descriptionCached)
+        result.numDescribeDropped = stages_.describer.describe(
+            dataBuffer_.back().cameraImg, dataBuffer_.back().keypoints, descriptors);
+    if (outputs_.cache && !reuseKeypoints && !descriptionCached)
+        outputs_.cache->storeDescriptors(descriptionKey, dataBuffer_.back().keypoints, descriptors);
+    // The cache keeps float rows; quantizing on the way out is cheap and lossless.
+    if (settings_.bQuantizeDescriptors && descriptors.type() == CV_32F)
+        quantizeDescriptorRows(descriptors, descriptors);
+    padDescriptorRows(descriptors, descriptors);   // no-op for fused / quantized rows
+    dataBuffer_.back().descriptors = descriptors;
+    result.describeMs = elapsedMs(t);
+    cout << "#3 : EXTRACT DESCRIPTORS done" << (descriptionCached ? " (cached)" : "") << endl;
+
+    /* --- 5. Match (requires >= 2 frames) --- */
+    if ((int)dataBuffer_.size() > 1)
+    {
+        t = (double)cv::getTickCount();
+        vector<cv::DMatch> matches;
+        MatchStats stats;
+        stages_.matcher.match(dataBuffer_[dataBuffer_.size() - 2].descriptors,
+                              dataBuffer_.back().descriptors,
+                              matches, &stats);
+        result.matchMs    = elapsedMs(t);
+        result.numMatches = matches.size();
+
+        dataBuffer_.back().kptMatches = matches;
+
+        logMatches(outputs_, imgIndex, detectorType, descriptorType,
+                   matches, result.matchMs);
+        cout << "Image " << imgIndex << " - " << detectorType << "/"
+             << descriptorType << ": " << matches.size() << " matches\n";
+        logMatchStats(stats);
+        cout << "#4 : MATCH KEYPOINT DESCRIPTORS done" << endl;
+
+        /* --- 6. Optionally save visualisation (drawn and encoded off-thread) --- */
+        if (outputs_.imageWriter)
+        {
+            MatchImageJob job;
+            job.img1       = dataBuffer_[dataBuffer_.size() - 2].cameraImg;
+            job.keypoints1 = dataBuffer_[dataBuffer_.size() - 2].keypoints;
+            job.img2       = dataBuffer_.back().cameraImg;
+            job.keypoints2 = dataBuffer_.back().keypoints;
+            job.matches    = matches;
+
+            ostringstream ss;
+            ss << settings_.imageOutputDir << "match_" << detectorType << "_"
+               << descriptorType << "_frames_"
+               << (imgIndex - 1) << "_" << imgIndex;
+            job.pathStem = ss.str();
+            outputs_.imageWriter->submit(std::move(job));
+        }
+    }
+
+    /* --- 7. Optionally dump the full frame for offline replay --- */
+    if (outputs_.frameDump)
+    {
+        FrameDumpJob job;
+        job.imageIndex     = (uint32_t)imgIndex;
+        job.detectorType   = detectorType;
+        job.descriptorType = descriptorType;
+        job.keypoints      = dataBuffer_.back().keypoints;
+        job.descriptors    = dataBuffer_.back().descriptors;
+        job.matches        = dataBuffer_.back().kptMatches;
+        outputs_.frameDump->submit(std::move(job));
+    }
+    return result;
+}
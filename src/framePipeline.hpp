@@ -0,0 +1,136 @@
+#ifndef framePipeline_hpp
+#define framePipeline_hpp
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <ostream>
+#include <stdexcept>
+
+#include <opencv2/core.hpp>
+
+#include "dataStructures.h"
+#include "matching2D.hpp"
+
+class AsyncImageWriter;
+class BinaryLog;
+class FrameDumpWriter;
+class ResultCache;
+
+// ---------------------------------------------------------------------------
+// Named constant for the preceding-vehicle ROI
+// ---------------------------------------------------------------------------
+inline const cv::Rect kVehicleROI(535, 180, 180, 150);
+
+// ---------------------------------------------------------------------------
+// Settings shared by every frame of a run (file sweep or stream ingest).
+// ---------------------------------------------------------------------------
+struct PipelineSettings
+{
+    std::string matcherType    = "MAT_BF";
+    std::string selectorType   = "SEL_KNN";
+    MatchConfig matchConfig;           // ratio, k, mutual, max distance
+    int    dataBufferSize  = 2;
+    bool   bFocusOnVehicle = true;
+    bool   bFuseDetectDescribe = true; // one detectAndCompute pass for ORB/BRISK/AKAZE/SIFT pairs
+    bool   bQuantizeDescriptors = false; // SIFT as uint8 rows, matched with integer L2
+    bool   bParallelMatch  = true;  // MAT_BF_PAR on sharedThreadPool(); off runs its blocks serially
+    KeypointBudget keypointBudget;     // top-K by response after ROI filtering
+    ThresholdControl thresholdControl; // FAST / BRISK / AKAZE: hold a keypoint count
+    bool   bSaveImages     = false; // off by default -- avoids 300+ output files
+    std::string imageOutputDir = "../images/outputs/"; // match images (with an imageWriter)
+};
+
+// ---------------------------------------------------------------------------
+// Detector, descriptor and matcher for one combination, resolved from their
+// names once so that the per-frame path never dispatches on strings.
+// ---------------------------------------------------------------------------
+struct PipelineStages
+{
+    KeypointDetector  detector;
+    KeypointDescriber describer;
+    FrameMatcher      matcher;
+    bool              fused;    // detector and descriptor run as one detectAndCompute
+    bool              masked;   // fused, with the ROI as detection mask (desc.maskable)
+
+    // Throws std::invalid_argument on unknown names or an invalid match
+    // config, std::runtime_error if a contrib-only algorithm is missing.
+    PipelineStages(const DetectorInfo &det, const DescriptorInfo &desc,
+                   const PipelineSettings &settings);
+};
+
+// ---------------------------------------------------------------------------
+// Sinks that per-frame results go to (and the cache they are read back
+// from). All optional and owned by the caller; null means "not wanted".
+// ---------------------------------------------------------------------------
+struct PipelineOutputs
+{
+    std::ostream *keypointLog = nullptr;     // keypoint_log.csv rows
+    std::ostream *matchLog    = nullptr;     // match_log.csv rows
+    AsyncImageWriter *imageWriter = nullptr; // set when --save is given
+
+    BinaryLog *keypointBinLog = nullptr; // --binlog: per-frame rows
+    BinaryLog *matchBinLog    = nullptr;
+    BinaryLog *keypointDump   = nullptr; // --binlog-keypoints: per-keypoint rows
+    BinaryLog *matchDump      = nullptr; // --binlog-matches: per-match rows
+
+    FrameDumpWriter *frameDump = nullptr; // --dump: keypoints, descriptors, matches
+    ResultCache     *cache     = nullptr; // --cache: skip detection/description on a hit
+};
+
+// ---------------------------------------------------------------------------
+// Per-frame shortcuts, requested by a FrameScheduler when it is behind.
+// ---------------------------------------------------------------------------
+struct FrameShortcuts
+{
+    size_t maxKeypoints   = 0;     // tighter keypoint budget for this frame; 0: settings'
+    bool   reuseKeypoints = false; // describe the previous frame's keypoints, skip detection
+};
+
+// ---------------------------------------------------------------------------
+// One detector + descriptor combination processing a sequence of frames.
+// Holds the ring buffer of the last settings.dataBufferSize frames; images
+// passed to process() are referenced, not copied, while they are buffered.
+// ---------------------------------------------------------------------------
+class FramePipeline
+{
+  public:
+    // Resolves the names through FeatureRegistry. Throws like PipelineStages,
+    // and std::invalid_argument on an invalid threshold control.
+    FramePipeline(const std::string &detectorType, const std::string &descriptorType,
+                  const PipelineSettings &settings, const PipelineOutputs &outputs);
+
+    // Run detection, description and matching on one grayscale frame and
+    // push it into the ring buffer. Shortcuts bypass the threshold controller.
+    FrameResult process(const cv::Mat &imgGray, size_t imgIndex,
+                        const FrameShortcuts &shortcuts = FrameShortcuts());
+
+    const std::deque<DataFrame> &buffer() const { return dataBuffer_; }
+    const PipelineSettings &settings() const { return settings_; }
+    const PipelineStages &stages() const { return stages_; }
+    const PipelineOutputs &outputs() const { return outputs_; }
+
+  private:
+    PipelineSettings settings_;
+    PipelineStages stages_;
+    ThresholdController thresholdController_;
+    cv::Mat roiMask_;                  // kVehicleROI as a detection mask (stages_.masked)
+    PipelineOutputs outputs_;
+    std::deque<DataFrame> dataBuffer_; // Deque gives O(1) pop_front
+};
+
+// Match CSV row plus binary match rows, as written for every frame pair.
+void logMatches(const PipelineOutputs &outputs, size_t imgIndex,
+                const std::string &detectorType, const std::string &descriptorType,
+                const std::vector<cv::DMatch> &matches, double matchMs);
+
+// Survivors and cost of each matching stage (see MatchConfig), to stdout.
+void logMatchStats(const MatchStats &stats);
+
+// Milliseconds since a cv::getTickCount() reading.
+inline double elapsedMs(double since)
+{
+    return 1000.0 * ((double)cv::getTickCount() - since) / cv::getTickFrequency();
+}
+
+#endif /* framePipeline_hpp */
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+
+#include "frameScheduler.hpp"
+
+using namespace std;
+
+const char *frameActionName(FrameAction action)
+{
+    switch (action)
+    {
+    case FrameAction::FULL:    return "FULL";
+    case FrameAction::DEGRADE: return "DEGRADE";
+    case FrameAction::REUSE:   return "REUSE";
+    case FrameAction::DROP:    return "DROP";
+    }
+    return "?";
+}
+
+void writeScheduleLogHeader(ostream &out)
+{
+    out << "ImageIndex,DetectorType,DescriptorType,Action,FrameMs,DeadlineMs,BacklogMs,Missed,Reason\n";
+}
+
+FrameScheduler::FrameScheduler(const DeadlineSettings &settings, ostream *log)
+    : settings_(settings), log_(log)
+{
+    if (!settings.enabled())
+        throw invalid_argument("FrameScheduler: deadline must be > 0 ms");
+}
+
+// ---------------------------------------------------------------------------
+// Planning
+// ---------------------------------------------------------------------------
+FrameAction FrameScheduler::plan(bool canDrop)
+{
+    const double deadline = settings_.deadlineMs;
+    ostringstream reason;
+    reason << "backlog " << backlogMs_ << " ms";
+
+    FrameAction action;
+    if (backlogMs_ <= 0.0)
+    {
+        action = FrameAction::FULL;
+        reason.str("on schedule");
+    }
+    else if (backlogMs_ < 0.5 * deadline)
+        action = FrameAction::DEGRADE;
+    else if (backlogMs_ < deadline || !canDrop)
+    {
+        action = FrameAction::REUSE;
+        if (backlogMs_ >= deadline)
+            reason << "; drop not possible";
+    }
+    else
+        action = FrameAction::DROP;
+
+    reason_ = reason.str();
+    return action;
+}
+
+FrameShortcuts FrameScheduler::shortcuts(FrameAction action) const
+{
+    FrameShortcuts s;
+    if (action == FrameAction::DEGRADE || action == FrameAction::REUSE)
+        s.maxKeypoints = settings_.degradedKeypoints;
+    s.reuseKeypoints = action == FrameAction::REUSE;
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// Accounting
+// ---------------------------------------------------------------------------
+void FrameScheduler::record(size_t imgIndex, const string &detectorType,
+                            const string &descriptorType, FrameAction action,
+                            const FrameResult &result, double frameMs)
+{
+    const double deadline = settings_.deadlineMs;
+    const bool missed = action != FrameAction::DROP && frameMs > deadline;
+
+    string reason = reason_;
+    if (missed)
+    {
+        // Name the stage that ate the budget.
+        const char *stage = "detect";
+        double stageMs = result.detectMs;
+        if (result.describeMs > stageMs) { stage = "describe"; stageMs = result.describeMs; }
+        if (result.matchMs > stageMs)    { stage = "match";    stageMs = result.matchMs; }
+        ostringstream ss;
+        ss << "; over by " << frameMs - deadline << " ms, " << stage << " " << stageMs << " ms";
+        reason += ss.str();
+    }
+
+    // A dropped frame costs (almost) nothing and frees a whole slot.
+    backlogMs_ = max(0.0, backlogMs_ + frameMs - deadline);
+    ++frames_;
+    missed_ += missed;
+    ++actions_[(int)action];
+
+    if (log_)
+        *log_ << imgIndex << "," << detectorType << "," << descriptorType << ","
+              << frameActionName(action) << "," << frameMs << "," << deadline << ","
+              << backlogMs_ << "," << (missed ? 1 : 0) << ",\"" << reason << "\"\n";
+    if (action != FrameAction::FULL || missed)
+        cout << "Scheduler: frame " << imgIndex << " " << frameActionName(action)
+             << " (" << reason << ")\n";
+}
+
+void FrameScheduler::printSummary(ostream &out) const
+{
+    out << "Deadline " << settings_.deadlineMs << " ms: " << frames_ << " frames, "
+        << missed_ << " missed, " << count(FrameAction::DEGRADE) << " degraded, "
+        << count(FrameAction::REUSE) << " reused keypoints, "
+        << count(FrameAction::DROP) << " dropped\n";
+}
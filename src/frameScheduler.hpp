@@ -0,0 +1,76 @@
+#ifndef frameScheduler_hpp
+#define frameScheduler_hpp
+
+#include <string>
+#include <ostream>
+#include <stdexcept>
+
+#include "dataStructures.h"
+#include "framePipeline.hpp"
+
+// ---------------------------------------------------------------------------
+// Deadline-aware scheduling for real-time ingest.
+//
+// Every frame has deadlineMs of wall time. Overruns accumulate into a
+// backlog (time the tracker is behind its input); frames that finish early
+// pay it back, and a dropped frame pays back a whole deadline. Before each
+// frame the backlog picks how much work to do:
+//
+//   backlog == 0                         FULL     normal processing
+//   0 < backlog < deadline / 2           DEGRADE  keypoint budget cut to degradedKeypoints
+//   deadline / 2 <= backlog < deadline   REUSE    as DEGRADE, describing the previous
+//                                                 frame's keypoints instead of detecting
+//   backlog >= deadline                  DROP     skip the frame entirely
+// ---------------------------------------------------------------------------
+enum class FrameAction { FULL, DEGRADE, REUSE, DROP };
+
+const char *frameActionName(FrameAction action);
+
+struct DeadlineSettings
+{
+    double deadlineMs        = 0.0;  // per-frame wall-time budget; 0 disables scheduling
+    size_t degradedKeypoints = 100;  // keypoint budget for DEGRADE / REUSE frames
+
+    bool enabled() const { return deadlineMs > 0.0; }
+};
+
+class FrameScheduler
+{
+  public:
+    // `log` receives one schedule_log.csv row per frame (may be null).
+    // Throws std::invalid_argument unless settings.deadlineMs > 0.
+    FrameScheduler(const DeadlineSettings &settings, std::ostream *log);
+
+    // Action for the next frame. With canDrop false a DROP is downgraded to
+    // REUSE (e.g. when skipping would pin a shared-memory slot).
+    FrameAction plan(bool canDrop = true);
+
+    // What the pipeline should cut for a planned action.
+    FrameShortcuts shortcuts(FrameAction action) const;
+
+    // Account for a finished (or dropped) frame and log its row.
+    void record(size_t imgIndex, const std::string &detectorType,
+                const std::string &descriptorType, FrameAction action,
+                const FrameResult &result, double frameMs);
+
+    size_t frames() const { return frames_; }
+    size_t missed() const { return missed_; }
+    size_t count(FrameAction action) const { return actions_[(int)action]; }
+    double backlogMs() const { return backlogMs_; }
+
+    // One-line summary: frames, misses and how many took each action.
+    void printSummary(std::ostream &out) const;
+
+  private:
+    DeadlineSettings settings_;
+    std::ostream *log_;
+    double backlogMs_ = 0.0;
+    std::string reason_;             // why plan() chose its action
+    size_t frames_ = 0, missed_ = 0;
+    size_t actions_[4] = {0, 0, 0, 0};
+};
+
+// Header row matching FrameScheduler::record.
+void writeScheduleLogHeader(std::ostream &out);
+
+#endif /* frameScheduler_hpp */
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+
+#include "hashMatcher.hpp"
+#include "descriptorDistance.hpp"
+
+using namespace std;
+
+static const int kHashWords = HashPrefilterMatcher::kHashBits / 64;
+
+HashPrefilterMatcher::HashPrefilterMatcher(int candidates, uint64_t seed)
+    : candidates_(candidates), seed_(seed)
+{
+    if (candidates < 1)
+        throw invalid_argument("HashPrefilterMatcher: candidates must be >= 1");
+}
+
+void HashPrefilterMatcher::hash(const cv::Mat &descriptors, vector<uint64_t> &codes) const
+{
+    cv::Mat x;
+    descriptors.convertTo(x, CV_32F);   // packed copy; quantized rows become floats
+    for (int r = 0; r < x.rows; ++r)
+    {
+        float *row = x.ptr<float>(r);
+        float mean = 0.f;
+        for (int c = 0; c < x.cols; ++c)
+            mean += row[c];
+        mean /= (float)x.cols;
+        for (int c = 0; c < x.cols; ++c)
+            row[c] -= mean;   // SIFT is non-negative: uncentred, every sign would lean one way
+    }
+
+    if (projection_.cols != x.cols)
+    {
+        projection_.create(kHashBits, x.cols, CV_32F);
+        cv::RNG rng(seed_);
+        for (int r = 0; r < kHashBits; ++r)
+        {
+            float *p = projection_.ptr<float>(r);
+            for (int c = 0; c < x.cols; ++c)
+                p[c] = rng.gaussian(1.0);
+        }
+    }
+
+    cv::Mat projected;   // rows x kHashBits
+    cv::gemm(x, projection_, 1.0, cv::noArray(), 0.0, projected, cv::GEMM_2_T);
+    codes.assign((size_t)x.rows * kHashWords, 0);
+    for (int r = 0; r < x.rows; ++r)
+    {
+        const float *p = projected.ptr<float>(r);
+        uint64_t *code = &codes[(size_t)r * kHashWords];
+        for (int b = 0; b < kHashBits; ++b)
+            if (p[b] > 0.f)
+                code[b / 64] |= uint64_t(1) << (b % 64);
+    }
+}
+
+void HashPrefilterMatcher::knnMatch(const cv::Mat &query, const cv::Mat &ref, int k,
+                                    vector<vector<cv::DMatch>> &knn) const
+{
+    knn.assign(query.rows, vector<cv::DMatch>());
+    if (query.empty() || ref.empty())
+        return;
+    if (query.cols != ref.cols || query.type() != ref.type())
+        throw invalid_argument("HashPrefilterMatcher::knnMatch: query and reference rows differ");
+
+    vector<uint64_t> queryCodes, refCodes;
+    hash(query, queryCodes);
+    hash(ref, refCodes);
+
+    const int shortlist = min(candidates_, ref.rows);
+    vector<pair<int, int>> ranked(ref.rows);   // (Hamming distance, reference row)
+    for (int i = 0; i < query.rows; ++i)
+    {
+        const uint64_t *q = &queryCodes[(size_t)i * kHashWords];
+        for (int j = 0; j < ref.rows; ++j)
+        {
+            const uint64_t *r = &refCodes[(size_t)j * kHashWords];
+            int d = 0;
+            for (int w = 0; w < kHashWords; ++w)
+                d += __builtin_popcountll(q[w] ^ r[w]);
+            ranked[j] = {d, j};
+        }
+        if (shortlist < ref.rows)
+            nth_element(ranked.begin(), ranked.begin() + shortlist, ranked.end());
+
+        vector<cv::DMatch> &best = knn[i];
+        for (int n = 0; n < shortlist; ++n)
+        {
+            const int j = ranked[n].second;
+            best.emplace_back(i, j, descriptorDistance(query, i, ref, j, cv::NORM_L2));
+        }
+        sort(best.begin(), best.end(),
+             [](const cv::DMatch &a, const cv::DMatch &b) { return a.distance < b.distance; });
+        if ((int)best.size() > k)
+            best.resize(k);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef hashMatcher_hpp
+#define hashMatcher_hpp
+
+#include <vector>
+#include <cstdint>
+
+#include <opencv2/core.hpp>
+
+// ---------------------------------------------------------------------------
+// Two-stage matcher for float descriptors (MAT_HASH).
+//
+// Every descriptor is reduced to a 256-bit sign hash of random projections
+// of its mean-centred row (SimHash: the Hamming distance between two codes
+// estimates the angle between the descriptors). A query ranks all reference
+// codes by Hamming distance -- four popcounts each -- and computes exact L2
+// only for the best `candidates`; the k nearest of those are returned as
+// knnMatch would. Approximate: a true neighbour ranked outside the
+// candidates is missed (--hash-recall measures this against MAT_BF).
+// ---------------------------------------------------------------------------
+class HashPrefilterMatcher
+{
+  public:
+    static constexpr int kHashBits = 256;
+
+    explicit HashPrefilterMatcher(int candidates = 8, uint64_t seed = 0x5EEDu);
+
+    int candidates() const { return candidates_; }
+
+    // k nearest reference rows of every query row, best first. CV_32F or
+    // quantized CV_8U rows of the same width on both sides. The projection
+    // is drawn on first use for a descriptor width, so concurrent calls on
+    // one matcher are not safe.
+    void knnMatch(const cv::Mat &query, const cv::Mat &ref, int k,
+                  std::vector<std::vector<cv::DMatch>> &knn) const;
+
+  private:
+    void hash(const cv::Mat &descriptors, std::vector<uint64_t> &codes) const;
+
+    int candidates_;
+    uint64_t seed_;
+    mutable cv::Mat projection_;   // kHashBits x descriptor width, CV_32F, N(0, 1)
+};
+
+#endif /* hashMatcher_hpp */
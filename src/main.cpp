@@ -1,30 +1,31 @@
 /* INCLUDES FOR THIS PROJECT */
+// Command-line client of the feature_tracking library: parses options, opens
+// the requested outputs and hands frames to a FramePipeline.
 #include <iostream>
 #include <fstream>
 #include <sstream>
-#include <iomanip>
 #include <vector>
-#include <deque>        // #8: O(1) pop_front for ring buffer
-#include <algorithm>    // #9: remove_if  #16: transform
+#include <algorithm>    // #16: transform
 #include <cctype>       // #16: toupper
 #include <stdexcept>    // #7: runtime_error
-#include <cmath>
-#include <limits>
+#include <cstdlib>      // atoi
+#include <cstdio>       // sscanf
+#include <memory>
 #include <opencv2/core.hpp>
-#include <opencv2/highgui/highgui.hpp>
-#include <opencv2/imgproc/imgproc.hpp>
-#include <opencv2/features2d.hpp>
 
-#include "dataStructures.h"
-#include "matching2D.hpp"
+#include "framePipeline.hpp"
+#include "pipelineRunners.hpp"
+#include "asyncImageWriter.hpp"
+#include "binaryLog.hpp"
+#include "frameDump.hpp"
+#include "resultCache.hpp"
+#include "frameScheduler.hpp"
+#include "pipelineConfig.hpp"
+#include "autoTune.hpp"
+#include "descriptorArena.hpp"
 
 using namespace std;
 
-// ---------------------------------------------------------------------------
-// Named constant for the preceding-vehicle ROI
-// ---------------------------------------------------------------------------
-static const cv::Rect kVehicleROI(535, 180, 180, 150);
-
 // ---------------------------------------------------------------------------
 // Normalise a detector/descriptor string to UPPERCASE in-place.
 // ---------------------------------------------------------------------------
@@ -36,231 +37,421 @@ static string toUpperCase(string s)
 }
 
 // ---------------------------------------------------------------------------
-// Load a single image as grayscale; throws std::runtime_error on failure.
-// ---------------------------------------------------------------------------
-static cv::Mat loadGrayscaleImage(const string &path)
-{
-    cv::Mat img = cv::imread(path);
-    if (img.empty())
-        throw runtime_error("loadGrayscaleImage: could not open '" + path + "'");
-    cv::Mat gray;
-    cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
-    return gray;
-}
-
-// ---------------------------------------------------------------------------
-// Detect keypoints and restrict them to the vehicle ROI.
+// main
 // ---------------------------------------------------------------------------
-static void detectAndFilterKeypoints(cv::Mat &img,
-                                     const string &detectorType,
-                                     vector<cv::KeyPoint> &keypoints,
-                                     bool bFocusOnVehicle)
+int main(int argc, char *argv[])
 {
-    detKeypoints(keypoints, img, detectorType, /*bVis=*/false);
+    /* --- Defaults (overridable via CLI) --- */
+    string singleDetector;    // empty -> test all detectors
+    string singleDescriptor;  // empty -> test all descriptors
+    PipelineSettings settings;
+
+    string         streamInput;  // empty -> read the KITTI image sequence
+    RawFrameFormat frameFormat;
+    string         recordFormatName = "TEXT";
+    string         shmName;      // non-empty -> shared-memory ingest
+    ImageWriterOptions writerOptions;
+    string         dropPolicyName = "BLOCK";
+    bool           bBinaryLog = false, bDumpKeypoints = false, bDumpMatches = false;
+    string         dumpPath;     // non-empty -> full keypoint/descriptor/match dump
+    string         replayPath;   // non-empty -> match-only replay of a dump
+    string         cacheDir;     // non-empty -> content-addressed result cache
+    DeadlineSettings deadline;   // deadlineMs > 0 -> schedule frames against it
+    double         autotuneBudgetMs = 0.0;  // > 0 -> sweep and pick a configuration
+    string         autotuneOut = "../autotune.cfg";
+    bool           bMatcherGiven = false;   // autotune sweeps matchers unless one is given
+    string         cameraList;   // non-empty -> synchronised multi-camera run, e.g. "0,1,2,3"
+    int            poolThreads = 0;          // 0 -> one worker per camera
+    bool           bPinThreads = true;
+    bool           bStereo = false;          // image_00 / image_01 left/right matching
+    StereoConfig   stereo;
 
-    if (bFocusOnVehicle)
+    /* --- CLI argument parsing --- */
+    //   Usage: ./2D_feature_tracking [--detector D] [--descriptor D]
+    //                                [--matcher M] [--selector S] [--save]
+    //                                [--stream PATH|- --width W --height H
+    //                                 [--stride S] [--records text|binary]]
+    //                                [--shm NAME]
+    //                                [--save-workers N] [--save-queue N]
+    //                                [--save-drop block|newest|oldest]
+    //                                [--save-format png|jpg] [--png-level 0-9]
+    //                                [--jpeg-quality 0-100]
+    //                                [--binlog] [--binlog-keypoints] [--binlog-matches]
+    //                                [--dump FILE] [--replay FILE] [--cache DIR]
+    //                                [--ratio R] [--knn-k K] [--mutual] [--max-dist D]
+    //                                [--max-keypoints N] [--grid CxR]
+    //                                [--target-keypoints N] [--target-band F]
+    //                                [--deadline MS] [--degraded-keypoints N]
+    //                                [--config FILE] [--autotune MS [--autotune-out FILE]]
+    //                                [--cameras 0,1,2,3 [--threads N] [--no-pin]]
+    //                                [--stereo [--stereo-band PX] [--max-disparity PX]]
+    //                                [--no-fuse] [--quantize]
+    //                                [--hash-candidates N] [--hash-recall]
+    const char *usage =
+        "\nUsage: ./2D_feature_tracking [--detector D] [--descriptor D]"
+        " [--matcher M] [--selector S] [--save]"
+        " [--stream PATH|- --width W --height H [--stride S] [--records text|binary]]"
+        " [--shm NAME] [--save-workers N] [--save-queue N]"
+        " [--save-drop block|newest|oldest] [--save-format png|jpg]"
+        " [--png-level 0-9] [--jpeg-quality 0-100]"
+        " [--binlog] [--binlog-keypoints] [--binlog-matches] [--dump FILE] [--replay FILE] [--cache DIR]"
+        " [--ratio R] [--knn-k K] [--mutual] [--max-dist D]"
+        " [--max-keypoints N] [--grid CxR] [--target-keypoints N] [--target-band F]"
+        " [--deadline MS] [--degraded-keypoints N]"
+        " [--config FILE] [--autotune MS [--autotune-out FILE]]"
+        " [--cameras 0,1,2,3 [--threads N] [--no-pin]]"
+        " [--stereo [--stereo-band PX] [--max-disparity PX]] [--no-fuse] [--quantize]"
+        " [--hash-candidates N] [--hash-recall]\n";
+    for (int i = 1; i < argc; ++i)
     {
-        // Erase-remove idiom -- O(n) instead of the O(n^2) manual-erase loop.
-        keypoints.erase(
-            remove_if(keypoints.begin(), keypoints.end(),
-                      [](const cv::KeyPoint &kp){ return !kVehicleROI.contains(kp.pt); }),
-            keypoints.end());
+        string arg = argv[i];
+        if      (arg == "--detector"   && i + 1 < argc) singleDetector        = toUpperCase(argv[++i]);
+        else if (arg == "--descriptor" && i + 1 < argc) singleDescriptor      = toUpperCase(argv[++i]);
+        else if (arg == "--matcher"    && i + 1 < argc) { settings.matcherType = toUpperCase(argv[++i]); bMatcherGiven = true; }
+        else if (arg == "--selector"   && i + 1 < argc) settings.selectorType = toUpperCase(argv[++i]);
+        else if (arg == "--save")                        settings.bSaveImages  = true;
+        else if (arg == "--stream"     && i + 1 < argc) streamInput           = argv[++i];
+        else if (arg == "--width"      && i + 1 < argc) frameFormat.width     = atoi(argv[++i]);
+        else if (arg == "--height"     && i + 1 < argc) frameFormat.height    = atoi(argv[++i]);
+        else if (arg == "--stride"     && i + 1 < argc) frameFormat.stride    = atoi(argv[++i]);
+        else if (arg == "--records"    && i + 1 < argc) recordFormatName      = toUpperCase(argv[++i]);
+        else if (arg == "--shm"        && i + 1 < argc) shmName               = argv[++i];
+        else if (arg == "--save-workers" && i + 1 < argc) writerOptions.workers        = atoi(argv[++i]);
+        else if (arg == "--save-queue"   && i + 1 < argc) writerOptions.queueCapacity  = (size_t)atoi(argv[++i]);
+        else if (arg == "--save-drop"    && i + 1 < argc) dropPolicyName               = toUpperCase(argv[++i]);
+        else if (arg == "--save-format"  && i + 1 < argc) writerOptions.format         = toUpperCase(argv[++i]);
+        else if (arg == "--png-level"    && i + 1 < argc) writerOptions.pngCompression = atoi(argv[++i]);
+        else if (arg == "--jpeg-quality" && i + 1 < argc) writerOptions.jpegQuality    = atoi(argv[++i]);
+        else if (arg == "--binlog")                         bBinaryLog     = true;
+        else if (arg == "--binlog-keypoints")               bDumpKeypoints = true;
+        else if (arg == "--binlog-matches")                 bDumpMatches   = true;
+        else if (arg == "--dump"         && i + 1 < argc) dumpPath                   = argv[++i];
+        else if (arg == "--replay"       && i + 1 < argc) replayPath                 = argv[++i];
+        else if (arg == "--cache"        && i + 1 < argc) cacheDir                   = argv[++i];
+        else if (arg == "--ratio"        && i + 1 < argc) settings.matchConfig.ratio       = (float)atof(argv[++i]);
+        else if (arg == "--knn-k"        && i + 1 < argc) settings.matchConfig.k           = atoi(argv[++i]);
+        else if (arg == "--mutual")                         settings.matchConfig.mutual      = true;
+        else if (arg == "--max-dist"     && i + 1 < argc) settings.matchConfig.maxDistance = (float)atof(argv[++i]);
+        else if (arg == "--max-keypoints" && i + 1 < argc) settings.keypointBudget.maxKeypoints = (size_t)atoi(argv[++i]);
+        else if (arg == "--target-keypoints" && i + 1 < argc) settings.thresholdControl.targetKeypoints = (size_t)atoi(argv[++i]);
+        else if (arg == "--target-band"  && i + 1 < argc) settings.thresholdControl.band = atof(argv[++i]);
+        else if (arg == "--deadline"     && i + 1 < argc) deadline.deadlineMs = atof(argv[++i]);
+        else if (arg == "--degraded-keypoints" && i + 1 < argc) deadline.degradedKeypoints = (size_t)atoi(argv[++i]);
+        else if (arg == "--no-fuse")                        settings.bFuseDetectDescribe = false;
+        else if (arg == "--quantize")                       settings.bQuantizeDescriptors = true;
+        else if (arg == "--hash-candidates" && i + 1 < argc) settings.matchConfig.hashCandidates = atoi(argv[++i]);
+        else if (arg == "--hash-recall")                    settings.matchConfig.measureRecall = true;
+        else if (arg == "--stereo")                         bStereo = true;
+        else if (arg == "--stereo-band"  && i + 1 < argc) stereo.rowBand      = (float)atof(argv[++i]);
+        else if (arg == "--max-disparity" && i + 1 < argc) stereo.maxDisparity = (float)atof(argv[++i]);
+        else if (arg == "--cameras"      && i + 1 < argc) cameraList  = argv[++i];
+        else if (arg == "--threads"      && i + 1 < argc) poolThreads = atoi(argv[++i]);
+        else if (arg == "--no-pin")                         bPinThreads = false;
+        else if (arg == "--autotune"     && i + 1 < argc) autotuneBudgetMs = atof(argv[++i]);
+        else if (arg == "--autotune-out" && i + 1 < argc) autotuneOut      = argv[++i];
+        else if (arg == "--config"       && i + 1 < argc)
+        {
+            // Applied in place: options after --config override the file.
+            PipelineConfig config{singleDetector, singleDescriptor, settings};
+            try
+            {
+                loadPipelineConfig(argv[++i], config);
+            }
+            catch (const exception &e)
+            {
+                cerr << "[ERROR] " << e.what() << "\n";
+                return 1;
+            }
+            singleDetector   = config.detector;
+            singleDescriptor = config.descriptor;
+            settings         = config.settings;
+        }
+        else if (arg == "--grid"         && i + 1 < argc)
+        {
+            KeypointBudget &budget = settings.keypointBudget;
+            if (sscanf(argv[++i], "%dx%d", &budget.gridCols, &budget.gridRows) != 2
+                || budget.gridCols <= 0 || budget.gridRows <= 0)
+            {
+                cerr << "--grid expects CxR, e.g. 4x3" << usage;
+                return 1;
+            }
+        }
+        else { cerr << "Unknown argument: " << arg << usage; return 1; }
     }
-}
-
-// ---------------------------------------------------------------------------
-// Log per-frame keypoint statistics (uses '\n', not std::endl).
-// ---------------------------------------------------------------------------
-static void logKeypointStats(ofstream &log, size_t imgIndex,
-                             const string &detectorType,
-                             const vector<cv::KeyPoint> &keypoints)
-{
-    float minSz = numeric_limits<float>::max(), maxSz = 0.f, meanSz = 0.f;
-    for (const auto &kp : keypoints)
+    // The dump writer truncates its file up front, which would wipe the replay input.
+    if (!dumpPath.empty() && !replayPath.empty())
     {
-        minSz  = min(minSz,  kp.size);
-        maxSz  = max(maxSz,  kp.size);
-        meanSz += kp.size;
+        cerr << "--dump cannot be combined with --replay" << usage;
+        return 1;
     }
-    if (!keypoints.empty())  meanSz /= (float)keypoints.size();
-    else                     minSz  = 0.f;
 
-    log << imgIndex << "," << detectorType << "," << keypoints.size()
-        << "," << minSz << "," << maxSz << "," << meanSz << "\n"; // #11
+    const FeatureRegistry &registry = FeatureRegistry::instance();
 
-    cout << "Image " << imgIndex << " - " << detectorType << ": "
-         << keypoints.size() << " keypoints"
-         << "  (Min: " << minSz << "  Max: " << maxSz << "  Mean: " << meanSz << ")\n";
-}
-
-// ---------------------------------------------------------------------------
-// Full pipeline for one detector + descriptor combination.
-// ---------------------------------------------------------------------------
-static void runCombination(const string &detectorType,
-                           const string &descriptorType,
-                           const string &matcherType,
-                           const string &selectorType,
-                           const string &imgBasePath,
-                           const string &imgPrefix,
-                           const string &imgFileType,
-                           int imgStartIndex,
-                           int imgEndIndex,
-                           int imgFillWidth,
-                           int dataBufferSize,
-                           bool bFocusOnVehicle,
-                           bool bSaveImages,   // # Save images with keypoints drawn
-                           ofstream &keypointLog,
-                           ofstream &matchLog)
-{
-    deque<DataFrame> dataBuffer; // Deque gives O(1) pop_front
+    /* --- Image source configuration --- */
+    const ImageSequence sequence;   // the 10 bundled KITTI frames
 
-    for (size_t imgIndex = 0;
-         imgIndex <= (size_t)(imgEndIndex - imgStartIndex);
-         ++imgIndex)
+    // --cameras: KITTI image_0<i> for each listed index, sharing one pool.
+    vector<CameraSource> cameras;
     {
-        /* --- 1. Load image --- */
-        ostringstream num;
-        num << setfill('0') << setw(imgFillWidth) << imgStartIndex + (int)imgIndex;
-        const string imgPath = imgBasePath + imgPrefix + num.str() + imgFileType;
-
-        cv::Mat imgGray = loadGrayscaleImage(imgPath); // Load a single image as grayscale; throws std::runtime_error on failure
-
-        /* --- 2. Ring buffer (O(1) pop_front) --- */  // Deque gives O(1) pop_front
-        DataFrame frame;
-        frame.cameraImg = imgGray;
-        if ((int)dataBuffer.size() == dataBufferSize)
-            dataBuffer.pop_front();
-        dataBuffer.push_back(frame);
-
-        cout << "#1 : LOAD IMAGE INTO BUFFER done" << endl;
+        istringstream list(cameraList);
+        for (string item; getline(list, item, ',');)
+        {
+            if (item.empty() || item.find_first_not_of("0123456789") != string::npos)
+            {
+                cerr << "--cameras expects a comma-separated list of camera indices" << usage;
+                return 1;
+            }
+            cameras.push_back(kittiCamera(atoi(item.c_str())));
+        }
+    }
+    unique_ptr<ThreadPool> pool;
+    if (!cameras.empty())
+        pool.reset(new ThreadPool(poolThreads > 0 ? (size_t)poolThreads : cameras.size(), bPinThreads));
 
-        /* --- 3. Detect & filter keypoints --- */
-        vector<cv::KeyPoint> keypoints;
-        detectAndFilterKeypoints(dataBuffer.back().cameraImg,
-                                 detectorType, keypoints, bFocusOnVehicle);
-        logKeypointStats(keypointLog, imgIndex, detectorType, keypoints);
-        dataBuffer.back().keypoints = keypoints;
-        cout << "#2 : DETECT KEYPOINTS done" << endl;
+    /* --- Open log files --- */
+    ofstream keypointLog("../keypoint_log.csv");
+    ofstream matchLog("../match_log.csv");
+    keypointLog << "ImageIndex,DetectorType,NumKeypoints,MinSize,MaxSize,MeanSize\n"; // #11
+    matchLog    << "ImageIndex,DetectorType,DescriptorType,NumMatches\n";
 
-        /* --- 4. Extract descriptors --- */
-        cv::Mat descriptors;
-        descKeypoints(dataBuffer.back().keypoints,
-                      dataBuffer.back().cameraImg,
-                      descriptors, descriptorType);
-        dataBuffer.back().descriptors = descriptors;
-        cout << "#3 : EXTRACT DESCRIPTORS done" << endl;
+    ofstream stereoLog;
+    if (bStereo)
+    {
+        stereoLog.open("../stereo_log.csv");
+        stereoLog << "ImageIndex,DetectorType,DescriptorType,NumMatches,MedianDepthM,MinDepthM,"
+                     "Comparisons,BruteForce,MatchMs\n";
+    }
 
-        /* --- 5. Match (requires >= 2 frames) --- */
-        if ((int)dataBuffer.size() > 1)
+    /* --- Optional deadline scheduling (one scheduler per combination) --- */
+    ofstream scheduleLog;
+    if (deadline.enabled())
+    {
+        scheduleLog.open("../schedule_log.csv");
+        writeScheduleLogHeader(scheduleLog);
+    }
+    auto makeScheduler = [&]() {
+        return deadline.enabled() ? unique_ptr<FrameScheduler>(new FrameScheduler(deadline, &scheduleLog))
+                                  : unique_ptr<FrameScheduler>();
+    };
+
+    /* --- Optional background writer for match visualisations --- */
+    unique_ptr<AsyncImageWriter> imageWriter;
+    try
+    {
+        writerOptions.dropPolicy = parseDropPolicy(dropPolicyName);
+        if (settings.bSaveImages)
+            imageWriter.reset(new AsyncImageWriter(writerOptions));
+    }
+    catch (const invalid_argument &e)
+    {
+        cerr << e.what() << usage;
+        return 1;
+    }
+    PipelineOutputs outputs;
+    outputs.keypointLog = &keypointLog;
+    outputs.matchLog    = &matchLog;
+    outputs.imageWriter = imageWriter.get();
+
+    /* --- Optional append-only binary logs (see scripts/analyze.py) --- */
+    unique_ptr<BinaryLog> keypointBinLog, matchBinLog, keypointDump, matchDump;
+    unique_ptr<FrameDumpWriter> frameDump;
+    unique_ptr<ResultCache> cache;
+    try
+    {
+        if (!cacheDir.empty())
+            cache.reset(new ResultCache(cacheDir));
+        if (!dumpPath.empty())
+            frameDump.reset(new FrameDumpWriter(dumpPath));
+        if (bBinaryLog)
+        {
+            keypointBinLog.reset(new BinaryLog("../keypoint_log.bin", "KeypointLogRecord",
+                                               keypointLogSchema(), sizeof(KeypointLogRecord)));
+            matchBinLog.reset(new BinaryLog("../match_log.bin", "MatchLogRecord",
+                                            matchLogSchema(), sizeof(MatchLogRecord)));
+        }
+        if (bDumpKeypoints)
+            keypointDump.reset(new BinaryLog("../keypoint_dump.bin", "KeypointDumpRecord",
+                                             keypointDumpSchema(), sizeof(KeypointDumpRecord)));
+        if (bDumpMatches)
+            matchDump.reset(new BinaryLog("../match_dump.bin", "MatchDumpRecord",
+                                          matchDumpSchema(), sizeof(MatchDumpRecord)));
+    }
+    catch (const exception &e)
+    {
+        cerr << "[ERROR] " << e.what() << "\n";
+        return 1;
+    }
+    outputs.keypointBinLog = keypointBinLog.get();
+    outputs.matchBinLog    = matchBinLog.get();
+    outputs.keypointDump   = keypointDump.get();
+    outputs.matchDump      = matchDump.get();
+    outputs.frameDump      = frameDump.get();
+    outputs.cache          = cache.get();
+
+    /* --- Replay mode: matching only, from a previous --dump --- */
+    if (!replayPath.empty())
+    {
+        try
         {
-            vector<cv::DMatch> matches;
-            matchDescriptors(dataBuffer[dataBuffer.size() - 2].keypoints,
-                             dataBuffer.back().keypoints,
-                             dataBuffer[dataBuffer.size() - 2].descriptors,
-                             dataBuffer.back().descriptors,
-                             matches, descriptorType, matcherType, selectorType);
+            runReplay(replayPath, singleDetector, singleDescriptor, settings, outputs);
+        }
+        catch (const exception &e)
+        {
+            cerr << "[ERROR] replay: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
 
-            dataBuffer.back().kptMatches = matches;
+    /* --- Stream ingest mode: a single combination acting as a filter --- */
+    if (!streamInput.empty())
+    {
+        if (singleDetector.empty() || singleDescriptor.empty())
+        {
+            cerr << "--stream needs an explicit --detector and --descriptor" << usage;
+            return 1;
+        }
 
-            matchLog << imgIndex << "," << detectorType << ","    // #11
-                     << descriptorType << "," << matches.size() << "\n";
-            cout << "Image " << imgIndex << " - " << detectorType << "/"
-                 << descriptorType << ": " << matches.size() << " matches\n";
-            cout << "#4 : MATCH KEYPOINT DESCRIPTORS done" << endl;
+        // stdout carries the result records; route diagnostics to stderr.
+        ostream records(cout.rdbuf());
+        cout.rdbuf(cerr.rdbuf());
 
-            /* --- 6. Optionally save visualisation --- */
-            if (bSaveImages)
-            {
-                cv::Mat matchImg;
-                cv::drawMatches(dataBuffer[dataBuffer.size() - 2].cameraImg,
-                                dataBuffer[dataBuffer.size() - 2].keypoints,
-                                dataBuffer.back().cameraImg,
-                                dataBuffer.back().keypoints,
-                                matches, matchImg,
-                                cv::Scalar::all(-1), cv::Scalar::all(-1),
-                                vector<char>(),
-                                cv::DrawMatchesFlags::DRAW_RICH_KEYPOINTS);
-
-                ostringstream ss;
-                ss << "../images/outputs/match_" << detectorType << "_"
-                   << descriptorType << "_frames_"
-                   << (imgIndex - 1) << "_" << imgIndex << ".png";
-                cv::imwrite(ss.str(), matchImg);
-            }
+        int status = 0;
+        try
+        {
+            FramePipeline pipeline(singleDetector, singleDescriptor, settings, outputs);
+            unique_ptr<FrameScheduler> scheduler = makeScheduler();
+            runStream(pipeline, streamInput, frameFormat, parseRecordFormat(recordFormatName),
+                      records, scheduler.get());
+            if (scheduler)
+                scheduler->printSummary(cerr);
         }
-    } // eof image loop
-}
-
-// ---------------------------------------------------------------------------
-// main
-// ---------------------------------------------------------------------------
-int main(int argc, char *argv[])
-{
-    /* --- Defaults (overridable via CLI) --- */
-    string singleDetector;    // empty -> test all detectors
-    string singleDescriptor;  // empty -> test all descriptors
-    string matcherType  = "MAT_BF";
-    string selectorType = "SEL_KNN";
-    bool   bSaveImages  = false; // off by default -- avoids 300+ output files
+        catch (const exception &e)
+        {
+            cerr << "[ERROR] stream: " << e.what() << "\n";
+            status = 1;
+        }
+        cout.rdbuf(records.rdbuf());
+        return status;
+    }
 
-    /* --- CLI argument parsing --- */
-    //   Usage: ./2D_feature_tracking [--detector D] [--descriptor D]
-    //                                [--matcher M] [--selector S] [--save]
-    for (int i = 1; i < argc; ++i)
+    /* --- Shared-memory ingest mode --- */
+    if (!shmName.empty())
     {
-        string arg = argv[i];
-        if      (arg == "--detector"   && i + 1 < argc) singleDetector   = toUpperCase(argv[++i]);
-        else if (arg == "--descriptor" && i + 1 < argc) singleDescriptor = toUpperCase(argv[++i]);
-        else if (arg == "--matcher"    && i + 1 < argc) matcherType      = toUpperCase(argv[++i]);
-        else if (arg == "--selector"   && i + 1 < argc) selectorType     = toUpperCase(argv[++i]);
-        else if (arg == "--save")                        bSaveImages      = true;
-        else { cerr << "Unknown argument: " << arg
-                    << "\nUsage: ./2D_feature_tracking [--detector D] [--descriptor D]"
-                       " [--matcher M] [--selector S] [--save]\n"; return 1; }
+        if (singleDetector.empty() || singleDescriptor.empty())
+        {
+            cerr << "--shm needs an explicit --detector and --descriptor" << usage;
+            return 1;
+        }
+        try
+        {
+            FramePipeline pipeline(singleDetector, singleDescriptor, settings, outputs);
+            unique_ptr<FrameScheduler> scheduler = makeScheduler();
+            runShm(pipeline, shmName, scheduler.get());
+            if (scheduler)
+                scheduler->printSummary(cout);
+        }
+        catch (const exception &e)
+        {
+            cerr << "[ERROR] shm: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
     }
 
-    /* --- Image source configuration --- */
-    const string dataPath    = "../";
-    const string imgBasePath = dataPath + "images/";
-    const string imgPrefix   = "KITTI/2011_09_26/image_00/data/000000";
-    const string imgFileType = ".png";
-    const int imgStartIndex  = 0;
-    const int imgEndIndex    = 9;    // 10 images total
-    const int imgFillWidth   = 4;
-    const int dataBufferSize = 2;
-    const bool bFocusOnVehicle = true;
-
     /* --- Determine which combinations to run --- */
-    vector<string> detectorTypes   = {"SHITOMASI","HARRIS","FAST","BRISK","ORB","AKAZE","SIFT"};
-    vector<string> descriptorTypes = {"BRISK","ORB","AKAZE","SIFT","BRIEF","FREAK"};
+    vector<string> detectorTypes   = registry.detectorNames();
+    vector<string> descriptorTypes = registry.descriptorNames();
     if (!singleDetector.empty())   detectorTypes   = {singleDetector};
     if (!singleDescriptor.empty()) descriptorTypes = {singleDescriptor};
 
-    /* --- Open log files --- */
-    ofstream keypointLog("../keypoint_log.csv");
-    ofstream matchLog("../match_log.csv");
-    keypointLog << "ImageIndex,DetectorType,NumKeypoints,MinSize,MaxSize,MeanSize\n"; // #11
-    matchLog    << "ImageIndex,DetectorType,DescriptorType,NumMatches\n";
+    /* --- Autotune mode: sweep, rank by latency and yield, write a config --- */
+    if (autotuneBudgetMs > 0.0)
+    {
+        // Cached or backgrounded stages would distort the timings.
+        PipelineOutputs tuneOutputs = outputs;
+        tuneOutputs.cache       = nullptr;
+        tuneOutputs.imageWriter = nullptr;
+        const vector<string> matcherTypes = bMatcherGiven ? vector<string>{settings.matcherType}
+                                                          : vector<string>{"MAT_BF", "MAT_BF_PAR", "MAT_FLANN",
+                                                                           "MAT_HASH", "MAT_MIH"};
+        const TuneResult tune = runAutoTune(sequence, settings, tuneOutputs, autotuneBudgetMs,
+                                            detectorTypes, descriptorTypes, matcherTypes);
+
+        ofstream report("../autotune_report.csv");
+        writeTuneReport(report, tune);
+
+        cout << "\n=== Autotune (budget " << autotuneBudgetMs << " ms/frame) ===\n"
+             << "Pareto front (fastest first):\n";
+        const TuneCandidate *best = tune.best >= 0 ? &tune.candidates[tune.best] : nullptr;
+        vector<const TuneCandidate *> front;
+        for (const auto &c : tune.candidates)
+            if (c.pareto)
+                front.push_back(&c);
+        sort(front.begin(), front.end(),
+             [](const TuneCandidate *a, const TuneCandidate *b) { return a->meanMs < b->meanMs; });
+        for (const TuneCandidate *c : front)
+            cout << "  " << (c == best ? "* " : "  ") << c->detector << " + " << c->descriptor
+                 << " + " << c->matcher << ": " << c->meanMs << " ms, " << c->meanMatches
+                 << " matches" << (c->withinBudget ? "" : " (over budget)") << "\n";
+        cout << "Report       : ../autotune_report.csv\n";
+
+        if (!best)
+        {
+            cerr << "[ERROR] autotune: no configuration meets " << autotuneBudgetMs << " ms/frame\n";
+            return 1;
+        }
+        PipelineConfig config{best->detector, best->descriptor, settings};
+        config.settings.matcherType = best->matcher;
+        ostringstream comment;
+        comment << "autotune: budget " << autotuneBudgetMs << " ms/frame; "
+                << best->meanMs << " ms/frame (max " << best->maxMs << "), "
+                << best->meanMatches << " matches/frame over " << best->frames << " frames";
+        try
+        {
+            savePipelineConfig(autotuneOut, config, comment.str());
+        }
+        catch (const exception &e)
+        {
+            cerr << "[ERROR] " << e.what() << "\n";
+            return 1;
+        }
+        cout << "Config       : " << autotuneOut << " (load with --config)\n";
+        return 0;
+    }
 
     /* --- Main loop --- */
     for (const string &det : detectorTypes)
     {
         for (const string &desc : descriptorTypes)
         {
-            // AKAZE descriptors only work with the AKAZE detector.
-            if (desc == "AKAZE" && det != "AKAZE") continue;
-
-            cout << "\n========================================\n"
-                 << "Testing: " << det << " + " << desc << "\n"
-                 << "========================================" << endl;
-
             try
             {
-                runCombination(det, desc, matcherType, selectorType,
-                               imgBasePath, imgPrefix, imgFileType,
-                               imgStartIndex, imgEndIndex, imgFillWidth,
-                               dataBufferSize, bFocusOnVehicle, bSaveImages,
-                               keypointLog, matchLog);
+                // Some descriptors only work on their own detector's keypoints.
+                if (!registry.compatible(det, desc)) continue;
+
+                cout << "\n========================================\n"
+                     << "Testing: " << det << " + " << desc << "\n"
+                     << "========================================" << endl;
+
+                if (bStereo)
+                {
+                    runStereo(kittiCamera(0), kittiCamera(1), det, desc, settings, outputs,
+                              stereo, &stereoLog);
+                    continue;
+                }
+                if (pool)
+                {
+                    printMultiCameraReport(cout, runMultiCamera(cameras, det, desc, settings,
+                                                                outputs, *pool));
+                    continue;
+                }
+
+                FramePipeline pipeline(det, desc, settings, outputs);
+                unique_ptr<FrameScheduler> scheduler = makeScheduler();
+                runImageSequence(pipeline, sequence, scheduler.get());
+                if (scheduler)
+                    scheduler->printSummary(cout);
             }
             catch (const exception &e)
             {
@@ -272,13 +463,38 @@ int main(int argc, char *argv[])
 
     keypointLog.close();
     matchLog.close();
+    scheduleLog.close();
+    stereoLog.close();
+    if (imageWriter)
+        imageWriter->close(); // wait for queued images before reporting
+    if (frameDump)
+        frameDump->close();
 
     cout << "\n=== Analysis Complete ===\n"
          << "Keypoint log : ../keypoint_log.csv\n"
          << "Match log    : ../match_log.csv\n";
-    if (bSaveImages)
-        cout << "Match images : ../images/outputs/\n";
+    if (deadline.enabled())
+        cout << "Schedule log : ../schedule_log.csv\n";
+    if (bStereo)
+        cout << "Stereo log   : ../stereo_log.csv\n";
+    if (keypointBinLog)
+        cout << "Binary logs  : ../keypoint_log.bin, ../match_log.bin\n";
+    if (keypointDump)
+        cout << "Keypoint dump: ../keypoint_dump.bin\n";
+    if (matchDump)
+        cout << "Match dump   : ../match_dump.bin\n";
+    if (cache)
+        cout << "Result cache : " << cacheDir
+             << " (detection " << cache->detectHits() << " hits / " << cache->detectMisses()
+             << " misses, description " << cache->describeHits() << " hits / "
+             << cache->describeMisses() << " misses)\n";
+    if (frameDump)
+        cout << "Frame dump   : " << dumpPath << " (" << frameDump->framesWritten() << " frames)\n";
+    if (imageWriter)
+        cout << "Match images : ../images/outputs/ (" << imageWriter->written()
+             << " written, " << imageWriter->dropped() << " dropped)\n";
+    cout << "Descriptors  : " << DescriptorArena::instance().reused() << " arena blocks reused, "
+         << DescriptorArena::instance().allocated() << " allocated\n";
 
     return 0;
 }
-
@@ -1,256 +1,688 @@
 #include <numeric>
 #include <stdexcept>
 #include <algorithm>
+#include <future>
+#include <exception>
 #include "matching2D.hpp"
+#include "descriptorArena.hpp"
+#include "descriptorDistance.hpp"
+#include "multiIndexHash.hpp"
+#include "threadPool.hpp"
 
 using namespace std;
 
+// ---------------------------------------------------------------------------
+// Name resolution (CLI boundary only)
+// ---------------------------------------------------------------------------
+MatcherKind parseMatcherKind(const string &name)
+{
+    if (name == "MAT_BF")    return MatcherKind::BF;
+    if (name == "MAT_BF_PAR") return MatcherKind::BF_PAR;
+    if (name == "MAT_FLANN") return MatcherKind::FLANN;
+    if (name == "MAT_HASH")  return MatcherKind::HASH;
+    if (name == "MAT_MIH")   return MatcherKind::MIH;
+    throw invalid_argument("parseMatcherKind: unknown matcherType '" + name + "'");
+}
+
+SelectorKind parseSelectorKind(const string &name)
+{
+    if (name == "SEL_NN")  return SelectorKind::NN;
+    if (name == "SEL_KNN") return SelectorKind::KNN;
+    throw invalid_argument("parseSelectorKind: unknown selectorType '" + name + "'");
+}
+
 // ---------------------------------------------------------------------------
 // Helper: determine descriptor norm category
 // ---------------------------------------------------------------------------
 bool isBinaryDescriptor(const string &descriptorType)
 {
-    // SIFT uses floating-point descriptors (L2); everything else is binary (Hamming).
-    return descriptorType != "SIFT";
+    return FeatureRegistry::instance().descriptor(descriptorType).normType == cv::NORM_HAMMING;
+}
+
+bool matcherApplies(MatcherKind matcher, bool binaryDescriptors)
+{
+    if (matcher == MatcherKind::HASH) return !binaryDescriptors;
+    if (matcher == MatcherKind::MIH)  return binaryDescriptors;
+    return true;
 }
 
 // ---------------------------------------------------------------------------
-// 5. Match descriptors
+// 1. Keypoint detection
+//    Our own kernels; OpenCV detectors are created by the registry below.
 // ---------------------------------------------------------------------------
-void matchDescriptors(vector<cv::KeyPoint> &kPtsSource, vector<cv::KeyPoint> &kPtsRef,
-                      cv::Mat &descSource, cv::Mat &descRef,
-                      vector<cv::DMatch> &matches,
-                      const string &descriptorType, const string &matcherType,
-                      const string &selectorType)
+void ShiTomasiKernel::detect(const cv::Mat &img, vector<cv::KeyPoint> &keypoints) const
 {
-    const bool binary  = isBinaryDescriptor(descriptorType);
-    const int  normType = binary ? cv::NORM_HAMMING : cv::NORM_L2;
+    const int   blockSize    = 4;
+    const double maxOverlap  = 0.0;
+    const double minDistance = (1.0 - maxOverlap) * blockSize;
+    const int   maxCorners   = img.rows * img.cols / max(1.0, minDistance);
 
-    cv::Ptr<cv::DescriptorMatcher> matcher;
-    if (matcherType == "MAT_BF")
+    vector<cv::Point2f> corners;
+    cv::goodFeaturesToTrack(img, corners, maxCorners,
+                            /*qualityLevel=*/0.01, minDistance,
+                            cv::Mat(), blockSize, /*useHarris=*/false, /*k=*/0.04);
+    // Corners come strongest first; their rank is the response the keypoint
+    // budget sorts by.
+    for (size_t i = 0; i < corners.size(); ++i)
     {
-        matcher = cv::BFMatcher::create(normType, /*crossCheck=*/false);
+        cv::KeyPoint kp;
+        kp.pt       = corners[i];
+        kp.size     = blockSize;
+        kp.response = (float)(corners.size() - i);
+        keypoints.push_back(kp);
     }
-    else if (matcherType == "MAT_FLANN")
+}
+
+void HarrisKernel::detect(const cv::Mat &img, vector<cv::KeyPoint> &keypoints) const
+{
+    const int    blockSize   = 2;
+    const int    apertureSize = 3;
+    const int    minResponse = 100;
+    const double k           = 0.04;
+    const double maxOverlap  = 0.0;
+
+    cv::Mat harrisRes, harrisNorm;
+    cv::cornerHarris(img, harrisRes, blockSize, apertureSize, k);
+    cv::normalize(harrisRes, harrisNorm, 0, 255, cv::NORM_MINMAX, CV_32F);
+
+    for (int j = 0; j < harrisNorm.rows; ++j)
     {
-        if (binary)
-        {
-            // LSH index is required for binary (Hamming-distance) descriptors.
-            // Using the default KD-Tree with binary descriptors would produce incorrect results.
-            matcher = cv::makePtr<cv::FlannBasedMatcher>(
-                cv::makePtr<cv::flann::LshIndexParams>(12, 20, 2));
-        }
-        else
+        for (int i = 0; i < harrisNorm.cols; ++i)
         {
-            matcher = cv::DescriptorMatcher::create(cv::DescriptorMatcher::FLANNBASED);
+            int response = (int)harrisNorm.at<float>(j, i);
+            if (response <= minResponse) continue;
+
+            cv::KeyPoint kp(cv::Point2f((float)i, (float)j),
+                            (float)(2 * apertureSize), -1, response);
+            bool bOverlap = false;
+            for (auto &existing : keypoints)
+            {
+                if (cv::KeyPoint::overlap(kp, existing) > maxOverlap)
+                {
+                    bOverlap = true;
+                    if (kp.response > existing.response)
+                        existing = kp;
+                    break;
+                }
+            }
+            if (!bOverlap)
+                keypoints.push_back(kp);
         }
     }
-    else
+}
+
+KeypointDetector::KeypointDetector(const DetectorInfo &info)
+    : name_(info.name), params_(info.params), range_(info.threshold),
+      createWithThreshold_(info.createWithThreshold), threshold_(info.threshold.initial),
+      kernel_(info.create())
+{
+}
+
+void KeypointDetector::setThreshold(double threshold)
+{
+    if (!range_.adjustable() || !createWithThreshold_)
+        throw logic_error("KeypointDetector::setThreshold: " + name_ + " has no adjustable threshold");
+    threshold = min(max(threshold, range_.min), range_.max);
+    if (threshold == threshold_)
+        return;
+    kernel_    = createWithThreshold_(threshold);
+    threshold_ = threshold;
+}
+
+void KeypointDetector::detect(const cv::Mat &img, vector<cv::KeyPoint> &keypoints) const
+{
+    double t = (double)cv::getTickCount();
+    visit([&](const auto &kernel) { kernel.detect(img, keypoints); }, kernel_);
+    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    cout << name_ << " detection with n=" << keypoints.size()
+         << " keypoints in " << 1000 * t << " ms" << endl;
+}
+
+// ---------------------------------------------------------------------------
+// 2. Keypoint budget
+// ---------------------------------------------------------------------------
+static bool strongerResponse(const cv::KeyPoint &a, const cv::KeyPoint &b)
+{
+    return a.response > b.response;
+}
+
+// Move the n strongest of [first, last) to the front.
+template <class It>
+static void partitionStrongest(It first, It last, size_t n)
+{
+    if ((size_t)(last - first) > n)
+        nth_element(first, first + n, last, strongerResponse);
+}
+
+void retainBestKeypoints(vector<cv::KeyPoint> &keypoints, const KeypointBudget &budget,
+                         const cv::Rect &area)
+{
+    const size_t maxKeypoints = budget.maxKeypoints;
+    if (!budget.enabled() || keypoints.size() <= maxKeypoints)
+        return;
+
+    if (!budget.gridded() || area.width <= 0 || area.height <= 0)
     {
-        throw invalid_argument("matchDescriptors: unknown matcherType '" + matcherType + "'");
+        partitionStrongest(keypoints.begin(), keypoints.end(), maxKeypoints);
+        keypoints.resize(maxKeypoints);
+        return;
     }
 
-    // Perform matching.
-    if (selectorType == "SEL_NN")
+    // Bucket by grid cell; points outside `area` are clamped to the border cells.
+    const int cells = budget.gridCols * budget.gridRows;
+    vector<vector<cv::KeyPoint>> buckets(cells);
+    for (const auto &kp : keypoints)
     {
-        matcher->match(descSource, descRef, matches);
+        int cx = (int)((kp.pt.x - area.x) * budget.gridCols / area.width);
+        int cy = (int)((kp.pt.y - area.y) * budget.gridRows / area.height);
+        cx = min(max(cx, 0), budget.gridCols - 1);
+        cy = min(max(cy, 0), budget.gridRows - 1);
+        buckets[cy * budget.gridCols + cx].push_back(kp);
     }
-    else if (selectorType == "SEL_KNN")
+
+    const size_t quota = max<size_t>(1, maxKeypoints / cells);
+    vector<cv::KeyPoint> kept, rest;
+    kept.reserve(maxKeypoints);
+    for (auto &bucket : buckets)
     {
-        vector<vector<cv::DMatch>> knn_matches;
-        matcher->knnMatch(descSource, descRef, knn_matches, 2);
+        partitionStrongest(bucket.begin(), bucket.end(), quota);
+        const size_t n = min(quota, bucket.size());
+        kept.insert(kept.end(), bucket.begin(), bucket.begin() + n);
+        rest.insert(rest.end(), bucket.begin() + n, bucket.end());
+    }
 
-        // Lowe's ratio test: discard ambiguous matches.
-        const float ratio_thresh = 0.8f;
-        for (const auto &m : knn_matches)
-        {
-            if (m[0].distance < ratio_thresh * m[1].distance)
-                matches.push_back(m[0]);
-        }
+    if (kept.size() > maxKeypoints)
+    {
+        // More cells than budget: the quota of 1 overshoots.
+        partitionStrongest(kept.begin(), kept.end(), maxKeypoints);
+        kept.resize(maxKeypoints);
     }
     else
     {
-        throw invalid_argument("matchDescriptors: unknown selectorType '" + selectorType + "'");
+        const size_t spare = min(maxKeypoints - kept.size(), rest.size());
+        partitionStrongest(rest.begin(), rest.end(), spare);
+        kept.insert(kept.end(), rest.begin(), rest.begin() + spare);
     }
+    keypoints.swap(kept);
 }
 
 // ---------------------------------------------------------------------------
-// 4. Compute descriptors
+// 3. Threshold controller
 // ---------------------------------------------------------------------------
-void descKeypoints(vector<cv::KeyPoint> &keypoints, cv::Mat &img,
-                   cv::Mat &descriptors, const string &descriptorType)
+ThresholdController::ThresholdController(const ThresholdControl &control, const ThresholdRange &range)
+    : control_(control), range_(range)
 {
-    cv::Ptr<cv::DescriptorExtractor> extractor;
-    if (descriptorType == "BRISK")
-    {
-        // Binary Robust Invariant Scalable Keypoints
-        extractor = cv::BRISK::create(/*threshold=*/30, /*octaves=*/3, /*patternScale=*/1.0f);
-    }
-    else if (descriptorType == "ORB")
+    if (control.band < 0.0 || control.gain < 0.0 || control.maxStep < 1.0)
+        throw invalid_argument("ThresholdController: band and gain must be >= 0 and maxStep >= 1");
+}
+
+double ThresholdController::next(double threshold, size_t count)
+{
+    if (!active())
+        return threshold;
+
+    // Detector thresholds work inversely: too many keypoints -> raise it.
+    const double ratio = (double)count / (double)control_.targetKeypoints;
+    const double error = fabs(ratio - 1.0);
+    if (error <= (settling_ ? 0.5 * control_.band : control_.band))
     {
-        // Oriented FAST + Rotated BRIEF -- parameters are shared with the ORB detector.
-        extractor = cv::ORB::create(
-            /*nfeatures=*/500, /*scaleFactor=*/1.2f, /*nlevels=*/8,
-            /*edgeThreshold=*/31, /*firstLevel=*/0, /*WTA_K=*/2,
-            cv::ORB::HARRIS_SCORE, /*patchSize=*/31, /*fastThreshold=*/20);
+        settling_ = false;
+        return threshold;
     }
-    else if (descriptorType == "AKAZE")
+    settling_ = true;
+
+    const double step = count == 0 ? 1.0 / control_.maxStep
+                                   : min(max(pow(ratio, control_.gain), 1.0 / control_.maxStep),
+                                         control_.maxStep);
+    double next = threshold * step;
+    if (range_.integral)
     {
-        // AKAZE descriptor -- must be paired with the AKAZE detector.
-        extractor = cv::AKAZE::create(
-            cv::AKAZE::DESCRIPTOR_MLDB, /*size=*/0, /*channels=*/3,
-            /*threshold=*/0.001f, /*nOctaves=*/4, /*nOctaveLayers=*/4,
-            cv::KAZE::DIFF_PM_G2);
+        next = round(next);
+        if (next == threshold)   // small corrections must still move an integer threshold
+            next += ratio > 1.0 ? 1.0 : -1.0;
     }
-    else if (descriptorType == "SIFT")
-    {
+    return min(max(next, range_.min), range_.max);
+}
+
+// ---------------------------------------------------------------------------
+// 4. Compute descriptors
+// ---------------------------------------------------------------------------
+KeypointDescriber::KeypointDescriber(const DescriptorInfo &info)
+    : name_(info.name), params_(info.params), normType_(info.normType), extractor_(info.create())
+{
+}
+
+size_t KeypointDescriber::rowBytes() const
+{
+    return (size_t)extractor_->descriptorSize() * CV_ELEM_SIZE(extractor_->descriptorType());
+}
+
+size_t KeypointDescriber::describe(const cv::Mat &img, vector<cv::KeyPoint> &keypoints,
+                                   cv::Mat &descriptors) const
+{
+    const size_t requested = keypoints.size();
+    double t = (double)cv::getTickCount();
+    descriptors.allocator = &DescriptorArena::instance();
+    extractor_->compute(img, keypoints, descriptors);
+    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    const size_t dropped = requested - keypoints.size();
+    cout << name_ << " descriptor extraction in " << 1000 * t << " ms";
+    if (dropped > 0)
+        cout << " (dropped " << dropped << " of " << requested << " keypoints)";
+    cout << endl;
+    return dropped;
+}
+
+void KeypointDescriber::detectAndDescribe(const cv::Mat &img, const cv::Mat &mask,
+                                          vector<cv::KeyPoint> &keypoints, cv::Mat &descriptors) const
+{
+    double t = (double)cv::getTickCount();
+    descriptors.allocator = &DescriptorArena::instance();
+    extractor_->detectAndCompute(img, mask, keypoints, descriptors);
+    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    cout << name_ << " fused detection + extraction with n=" << keypoints.size()
+         << " keypoints in " << 1000 * t << " ms" << endl;
+}
+
+// ---------------------------------------------------------------------------
+// Built-in registry entries. Parameters here are the single source of truth:
+// the params string goes into cache keys, so keep it in step with create().
+// ---------------------------------------------------------------------------
+static cv::Ptr<cv::Feature2D> createBrisk(int threshold = 30)
+{
+    // Multi-scale FAST with scale and rotation invariance.
+    return cv::BRISK::create(threshold, /*octaves=*/3, /*patternScale=*/1.0f);
+}
+
+static cv::Ptr<cv::Feature2D> createOrb()
+{
+    // oFAST keypoints + rBRIEF descriptors; shared by the detector and descriptor.
+    return cv::ORB::create(
+        /*nfeatures=*/500, /*scaleFactor=*/1.2f, /*nlevels=*/8,
+        /*edgeThreshold=*/31, /*firstLevel=*/0, /*WTA_K=*/2,
+        cv::ORB::HARRIS_SCORE, /*patchSize=*/31, /*fastThreshold=*/20);
+}
+
+static cv::Ptr<cv::Feature2D> createAkaze(float threshold = 0.001f)
+{
+    return cv::AKAZE::create(
+        cv::AKAZE::DESCRIPTOR_MLDB, /*size=*/0, /*channels=*/3,
+        threshold, /*nOctaves=*/4, /*nOctaveLayers=*/4,
+        cv::KAZE::DIFF_PM_G2);
+}
+
+static cv::Ptr<cv::Feature2D> createFast(int threshold = 30)
+{
+    // Features from Accelerated Segment Test.
+    return cv::FastFeatureDetector::create(threshold, /*NMS=*/true,
+                                           cv::FastFeatureDetector::TYPE_9_16);
+}
+
+// Entry for an OpenCV detector whose threshold the controller may adjust.
+template <class Factory>
+static DetectorInfo thresholdedDetector(const string &name, const string &params,
+                                        ThresholdRange range, Factory factory)
+{
+    DetectorInfo info;
+    info.name   = name;
+    info.params = params;
+    info.threshold = range;
+    info.createWithThreshold = [factory](double threshold) {
+        return DetectorKernel(OpenCvDetectorKernel{factory(threshold)});
+    };
+    info.create = [factory, range] { return DetectorKernel(OpenCvDetectorKernel{factory(range.initial)}); };
+    return info;
+}
+
+void registerBuiltinFeatures(FeatureRegistry &registry)
+{
+    const bool contrib = HAS_XFEATURES2D;
+    const string brisk = "thr=30;oct=3;scale=1";
+    const string orb   = "n=500;sf=1.2;lv=8;edge=31;first=0;wta=2;harris;patch=31;fast=20";
+    const string akaze = "mldb;size=0;ch=3;thr=0.001;oct=4;layers=4;pm_g2";
+
+    /* --- Detectors --- */
+    registry.addDetector({"SHITOMASI", "block=4;overlap=0;quality=0.01;k=0.04",
+                          [] { return DetectorKernel(ShiTomasiKernel()); }});
+    registry.addDetector({"HARRIS", "block=2;aperture=3;minResp=100;k=0.04;overlap=0",
+                          [] { return DetectorKernel(HarrisKernel()); }});
+    registry.addDetector(thresholdedDetector("FAST", "thr=30;nms=1;type=9_16", {30, 5, 120, true},
+                                             [](double thr) { return createFast((int)thr); }));
+    registry.addDetector(thresholdedDetector("BRISK", brisk, {30, 5, 120, true},
+                                             [](double thr) { return createBrisk((int)thr); }));
+    registry.addDetector({"ORB",   orb,   [] { return DetectorKernel(OpenCvDetectorKernel{createOrb()}); }});
+    registry.addDetector(thresholdedDetector("AKAZE", akaze, {0.001, 0.0001, 0.01, false},
+                                             [](double thr) { return createAkaze((float)thr); }));
+    registry.addDetector({"SIFT", "default", []() -> DetectorKernel {
 #if HAS_XFEATURES2D
-        extractor = cv::xfeatures2d::SIFT::create();
+        return OpenCvDetectorKernel{cv::xfeatures2d::SIFT::create()};
+#else
+        throw runtime_error("detKeypoints: SIFT requires opencv-contrib (xfeatures2d).");
+#endif
+    }, contrib});
+
+    /* --- Descriptors --- */
+    using Extractor = cv::Ptr<cv::Feature2D>;
+    registry.addDescriptor({"BRISK", brisk, [] { return createBrisk(); }, cv::NORM_HAMMING, "", true, true, true});
+    registry.addDescriptor({"ORB",   orb,   createOrb,   cv::NORM_HAMMING, "", true, true});
+    // AKAZE descriptors need the scale-space data of AKAZE keypoints.
+    registry.addDescriptor({"AKAZE", akaze, [] { return createAkaze(); }, cv::NORM_HAMMING, "AKAZE", true, true, true});
+    registry.addDescriptor({"SIFT", "default", []() -> Extractor {
+#if HAS_XFEATURES2D
+        return cv::xfeatures2d::SIFT::create();
 #else
         throw runtime_error("descKeypoints: SIFT requires opencv-contrib (xfeatures2d).");
 #endif
-    }
-    else if (descriptorType == "BRIEF")
-    {
+    }, cv::NORM_L2, "", contrib, true, true});
+    registry.addDescriptor({"BRIEF", "bytes=32", []() -> Extractor {
 #if HAS_XFEATURES2D
         // Not rotation-invariant by default; fast and compact (32-byte).
-        extractor = cv::xfeatures2d::BriefDescriptorExtractor::create(/*bytes=*/32);
+        return cv::xfeatures2d::BriefDescriptorExtractor::create(/*bytes=*/32);
 #else
         throw runtime_error("descKeypoints: BRIEF requires opencv-contrib (xfeatures2d).");
 #endif
-    }
-    else if (descriptorType == "FREAK")
-    {
+    }, cv::NORM_HAMMING, "", contrib});
+    registry.addDescriptor({"FREAK", "default", []() -> Extractor {
 #if HAS_XFEATURES2D
-        extractor = cv::xfeatures2d::FREAK::create();
+        return cv::xfeatures2d::FREAK::create();
 #else
         throw runtime_error("descKeypoints: FREAK requires opencv-contrib (xfeatures2d).");
 #endif
-    }
-    else
-    {
-        throw invalid_argument("descKeypoints: unknown descriptorType '" + descriptorType + "'");
-    }
-
-    double t = (double)cv::getTickCount();
-    extractor->compute(img, keypoints, descriptors);
-    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
-    cout << descriptorType << " descriptor extraction in " << 1000 * t << " ms" << endl;
+    }, cv::NORM_HAMMING, "", contrib});
 }
 
 // ---------------------------------------------------------------------------
-// 1. Unified keypoint detector
-//    Handles: SHITOMASI, HARRIS, FAST, BRISK, ORB, AKAZE, SIFT
+// 5. Match descriptors
 // ---------------------------------------------------------------------------
-void detKeypoints(vector<cv::KeyPoint> &keypoints, cv::Mat &img,
-                  const string &detectorType, bool bVis)
+static cv::Ptr<cv::DescriptorMatcher> createMatcher(MatcherKind kind, bool binary)
 {
-    double t = (double)cv::getTickCount();
+    if (kind != MatcherKind::FLANN)
+        return cv::BFMatcher::create(binary ? cv::NORM_HAMMING : cv::NORM_L2, /*crossCheck=*/false);
 
-    if (detectorType == "SHITOMASI")
+    // LSH index is required for binary (Hamming-distance) descriptors.
+    // Using the default KD-Tree with binary descriptors would produce incorrect results.
+    if (binary)
+        return cv::makePtr<cv::FlannBasedMatcher>(
+            cv::makePtr<cv::flann::LshIndexParams>(12, 20, 2));
+    return cv::DescriptorMatcher::create(cv::DescriptorMatcher::FLANNBASED);
+}
+
+// k nearest columns of every row of a CV_32F distance matrix, best first.
+// Row i is query row firstRow + i and goes to knn[firstRow + i].
+static void knnFromDistances(const cv::Mat &dist, int k, vector<vector<cv::DMatch>> &knn,
+                             int firstRow = 0)
+{
+    for (int i = 0; i < dist.rows; ++i)
     {
-        const int   blockSize    = 4;
-        const double maxOverlap  = 0.0;
-        const double minDistance = (1.0 - maxOverlap) * blockSize;
-        const int   maxCorners   = img.rows * img.cols / max(1.0, minDistance);
-
-        vector<cv::Point2f> corners;
-        cv::goodFeaturesToTrack(img, corners, maxCorners,
-                                /*qualityLevel=*/0.01, minDistance,
-                                cv::Mat(), blockSize, /*useHarris=*/false, /*k=*/0.04);
-        for (const auto &c : corners)
+        const float *row = dist.ptr<float>(i);
+        vector<cv::DMatch> &best = knn[firstRow + i];
+        best.clear();
+        for (int j = 0; j < dist.cols; ++j)
         {
-            cv::KeyPoint kp;
-            kp.pt   = c;
-            kp.size = blockSize;
-            keypoints.push_back(kp);
+            if ((int)best.size() == k && row[j] >= best.back().distance)
+                continue;
+            cv::DMatch m(firstRow + i, j, row[j]);
+            auto pos = upper_bound(best.begin(), best.end(), m,
+                                   [](const cv::DMatch &a, const cv::DMatch &b) { return a.distance < b.distance; });
+            best.insert(pos, m);
+            if ((int)best.size() > k)
+                best.pop_back();
         }
     }
-    else if (detectorType == "HARRIS")
-    {
-        const int    blockSize   = 2;
-        const int    apertureSize = 3;
-        const int    minResponse = 100;
-        const double k           = 0.04;
-        const double maxOverlap  = 0.0;
+}
 
-        cv::Mat harrisRes, harrisNorm;
-        cv::cornerHarris(img, harrisRes, blockSize, apertureSize, k);
-        cv::normalize(harrisRes, harrisNorm, 0, 255, cv::NORM_MINMAX, CV_32F);
+// Exact k-NN (MAT_BF with padded rows or --mutual, MAT_BF_PAR) with the
+// query rows cut into blocks. A block's distance matrix against the whole
+// train set stays in cache, its knn rows are its own, and its reverse-nearest
+// candidates go to its own buffer; the buffers are merged at the end. With a
+// pool each block is one task, and no task takes a lock.
+static const int kQueryBlockRows = 64;
 
-        for (int j = 0; j < harrisNorm.rows; ++j)
-        {
-            for (int i = 0; i < harrisNorm.cols; ++i)
-            {
-                int response = (int)harrisNorm.at<float>(j, i);
-                if (response <= minResponse) continue;
+static void blockedKnn(const cv::Mat &query, const cv::Mat &train, int normType, int k,
+                       vector<vector<cv::DMatch>> &knn, vector<int> *reverseBest,
+                       ThreadPool *pool)
+{
+    knn.assign(query.rows, vector<cv::DMatch>());
+    if (reverseBest)
+        reverseBest->assign(train.rows, -1);
+    if (query.empty() || train.empty())
+        return;
+
+    const int blocks = (query.rows + kQueryBlockRows - 1) / kQueryBlockRows;
+    vector<vector<float>> blockRevDist(reverseBest ? blocks : 0);
+    vector<vector<int>>   blockRevIdx(reverseBest ? blocks : 0);
 
-                cv::KeyPoint kp(cv::Point2f((float)i, (float)j),
-                                (float)(2 * apertureSize), -1, response);
-                bool bOverlap = false;
-                for (auto &existing : keypoints)
+    auto runBlock = [&](int b) {
+        const int first = b * kQueryBlockRows;
+        const int last  = min(first + kQueryBlockRows, query.rows);
+        cv::Mat dist;
+        descriptorDistanceMatrix(query.rowRange(first, last), train, normType, dist);
+        knnFromDistances(dist, k, knn, first);
+        if (!reverseBest)
+            return;
+        vector<float> &revDist = blockRevDist[b];
+        vector<int>   &revIdx  = blockRevIdx[b];
+        revDist.assign(dist.cols, numeric_limits<float>::max());
+        revIdx.assign(dist.cols, -1);
+        for (int i = 0; i < dist.rows; ++i)
+        {
+            const float *row = dist.ptr<float>(i);
+            for (int j = 0; j < dist.cols; ++j)
+                if (row[j] < revDist[j])
                 {
-                    if (cv::KeyPoint::overlap(kp, existing) > maxOverlap)
-                    {
-                        bOverlap = true;
-                        if (kp.response > existing.response)
-                            existing = kp;
-                        break;
-                    }
+                    revDist[j] = row[j];
+                    revIdx[j]  = first + i;
                 }
-                if (!bOverlap)
-                    keypoints.push_back(kp);
-            }
         }
-    }
+    };
+
+    vector<future<void>> done;
+    if (!pool || blocks == 1)   // one block is not worth a hand-off
+        for (int b = 0; b < blocks; ++b)
+            runBlock(b);
     else
+        for (int b = 0; b < blocks; ++b)
+            done.push_back(pool->submit([&runBlock, b] { runBlock(b); }));
+
+    // Wait for every block before rethrowing: the tasks reference our locals.
+    exception_ptr error;
+    for (auto &f : done)
+    {
+        try { f.get(); }
+        catch (...) { if (!error) error = current_exception(); }
+    }
+    if (error)
+        rethrow_exception(error);
+
+    if (reverseBest)
     {
-        // Modern OpenCV detector selected by name.
-        cv::Ptr<cv::FeatureDetector> detector;
-        if (detectorType == "FAST")
+        // Blocks in query order, strict '<': ties go to the lowest query row,
+        // as in the serial scan.
+        vector<float> best(train.rows, numeric_limits<float>::max());
+        for (int b = 0; b < blocks; ++b)
+            for (int j = 0; j < train.rows; ++j)
+                if (blockRevDist[b][j] < best[j])
+                {
+                    best[j] = blockRevDist[b][j];
+                    (*reverseBest)[j] = blockRevIdx[b][j];
+                }
+    }
+}
+
+// Best train row of every query row of a 1-NN result, -1 where none.
+static vector<int> nearestOf(const vector<vector<cv::DMatch>> &knn)
+{
+    vector<int> nearest(knn.size(), -1);
+    for (size_t i = 0; i < knn.size(); ++i)
+        if (!knn[i].empty())
+            nearest[i] = knn[i][0].trainIdx;
+    return nearest;
+}
+
+FrameMatcher::FrameMatcher(MatcherKind matcher, SelectorKind selector, bool binaryDescriptors,
+                           const MatchConfig &config)
+    : FrameMatcher(matcher, selector, binaryDescriptors, config,
+                   matcher == MatcherKind::BF_PAR ? &sharedThreadPool() : nullptr)
+{
+}
+
+FrameMatcher::FrameMatcher(MatcherKind matcher, SelectorKind selector, bool binaryDescriptors,
+                           const MatchConfig &config, ThreadPool *pool)
+    : matcherKind_(matcher), selector_(selector),
+      normType_(binaryDescriptors ? cv::NORM_HAMMING : cv::NORM_L2), config_(config),
+      matcher_(createMatcher(matcher, binaryDescriptors)),
+      hashMatcher_(max(config.hashCandidates, 1)), pool_(pool)
+{
+    const bool ratioTest = selector == SelectorKind::KNN && config.ratio < 1.0f;
+    if (config.k < 1 || (ratioTest && config.k < 2))
+        throw invalid_argument("FrameMatcher: k must be >= 2 for the ratio test (got "
+                               + to_string(config.k) + ")");
+    if (matcher == MatcherKind::HASH && config.hashCandidates < config.k)
+        throw invalid_argument("FrameMatcher: MAT_HASH needs at least k candidates (got "
+                               + to_string(config.hashCandidates) + ")");
+}
+
+void FrameMatcher::match(const cv::Mat &descSource, const cv::Mat &descRef,
+                         vector<cv::DMatch> &matches, MatchStats *stats) const
+{
+    const bool binary      = normType_ == cv::NORM_HAMMING;
+    const bool hashed      = matcherKind_ == MatcherKind::HASH && matcherApplies(matcherKind_, binary);
+    const bool multiIndex  = matcherKind_ == MatcherKind::MIH && matcherApplies(matcherKind_, binary);
+    const bool knnSelector = selector_ == SelectorKind::KNN;
+    const bool ratioTest   = knnSelector && config_.ratio < 1.0f;
+    const int  k           = knnSelector ? config_.k : 1;
+
+    MatchStats local;
+    MatchStats &st = stats ? *stats : local;
+    st = MatchStats();
+
+    // Neighbour search. knn[i] holds the candidates for source row i, best
+    // first; reverseBest[j] is the nearest source row of reference row j
+    // (only filled for mutual filtering).
+    double t = (double)cv::getTickCount();
+    vector<vector<cv::DMatch>> knn;
+    vector<int> reverseBest;
+    if (matcherKind_ == MatcherKind::BF
+        && (config_.mutual || paddedKernelsApply(descSource, descRef, normType_)))
+    {
+        // Our kernels for padded rows (including quantized SIFT); with
+        // --mutual the same distances serve both directions.
+        blockedKnn(descSource, descRef, normType_, k, knn,
+                   config_.mutual ? &reverseBest : nullptr, nullptr);
+    }
+    else if (matcherKind_ == MatcherKind::BF_PAR)
+    {
+        blockedKnn(descSource, descRef, normType_, k, knn,
+                   config_.mutual ? &reverseBest : nullptr, pool_);
+    }
+    else if (multiIndex)
+    {
+        // Exact, so the mutual check can use a second index on the source.
+        MultiIndexHash(descRef).knnSearch(descSource, k, knn);
+        if (config_.mutual)
         {
-            // Features from Accelerated Segment Test.
-            detector = cv::FastFeatureDetector::create(
-                /*threshold=*/30, /*NMS=*/true, cv::FastFeatureDetector::TYPE_9_16);
+            vector<vector<cv::DMatch>> reverse;
+            MultiIndexHash(descSource).knnSearch(descRef, 1, reverse);
+            reverseBest = nearestOf(reverse);
         }
-        else if (detectorType == "BRISK")
+    }
+    else if (hashed)
+    {
+        hashMatcher_.knnMatch(descSource, descRef, k, knn);
+        if (config_.mutual)
         {
-            // Multi-scale FAST with scale and rotation invariance.
-            detector = cv::BRISK::create(/*threshold=*/30, /*octaves=*/3, /*patternScale=*/1.0f);
+            vector<vector<cv::DMatch>> reverse;
+            hashMatcher_.knnMatch(descRef, descSource, 1, reverse);
+            reverseBest = nearestOf(reverse);
         }
-        else if (detectorType == "ORB")
+    }
+    else
+    {
+        // FLANN indexes need continuous rows (padded descriptor views are
+        // strided) and its KD-tree wants floats (not quantized SIFT).
+        const bool flann = matcherKind_ == MatcherKind::FLANN;
+        const bool toFloat = normType_ != cv::NORM_HAMMING;
+        auto flannInput = [&](const cv::Mat &d) {
+            cv::Mat m = d;
+            if (flann && toFloat && d.type() != CV_32F)
+                d.convertTo(m, CV_32F);
+            else if (flann && !d.isContinuous())
+                m = d.clone();
+            return m;
+        };
+        const cv::Mat source = flannInput(descSource), ref = flannInput(descRef);
+        matcher_->knnMatch(source, ref, knn, k);
+        if (config_.mutual)
         {
-            // oFAST keypoints + rBRIEF descriptors.
-            detector = cv::ORB::create(
-                /*nfeatures=*/500, /*scaleFactor=*/1.2f, /*nlevels=*/8,
-                /*edgeThreshold=*/31, /*firstLevel=*/0, /*WTA_K=*/2,
-                cv::ORB::HARRIS_SCORE, /*patchSize=*/31, /*fastThreshold=*/20);
+            vector<cv::DMatch> reverse;
+            matcher_->match(ref, source, reverse);
+            reverseBest.assign(descRef.rows, -1);
+            for (const auto &m : reverse)
+                reverseBest[m.queryIdx] = m.trainIdx;
         }
-        else if (detectorType == "AKAZE")
+    }
+    st.searchMs = ((double)cv::getTickCount() - t) / cv::getTickFrequency() * 1000.0;
+
+    // Recall of the hash prefilter: how often its best match is as close as
+    // the exact one (compared by distance, so ties do not count as misses;
+    // the slack absorbs rounding differences between the two L2 kernels).
+    if (hashed && config_.measureRecall && !descSource.empty() && !descRef.empty())
+    {
+        t = (double)cv::getTickCount();
+        vector<cv::DMatch> exact;
+        matcher_->match(descSource, descRef, exact);
+        st.exactMs = ((double)cv::getTickCount() - t) / cv::getTickFrequency() * 1000.0;
+        size_t found = 0;
+        for (const auto &m : exact)
+            if (!knn[m.queryIdx].empty() && knn[m.queryIdx][0].distance <= m.distance * 1.0001f)
+                ++found;
+        st.recall = exact.empty() ? -1.0 : (double)found / (double)exact.size();
+    }
+
+    // Filtering: ratio test, then mutual check, then distance cutoff.
+    t = (double)cv::getTickCount();
+    for (const auto &m : knn)
+    {
+        if (m.empty())
+            continue;
+        st.candidates += (ratioTest || !knnSelector) ? 1 : m.size();
+
+        // Lowe's ratio test: discard ambiguous matches. With the test
+        // disabled every retrieved neighbour goes on to the next stage.
+        size_t keep = m.size();
+        if (ratioTest)
         {
-            detector = cv::AKAZE::create(
-                cv::AKAZE::DESCRIPTOR_MLDB, /*size=*/0, /*channels=*/3,
-                /*threshold=*/0.001f, /*nOctaves=*/4, /*nOctaveLayers=*/4,
-                cv::KAZE::DIFF_PM_G2);
+            if (m.size() < 2 || !(m[0].distance < config_.ratio * m[1].distance))
+                continue;
+            keep = 1;
         }
-        else if (detectorType == "SIFT")
+        else if (!knnSelector)
         {
-#if HAS_XFEATURES2D
-            detector = cv::xfeatures2d::SIFT::create();
-#else
-            throw runtime_error("detKeypoints: SIFT requires opencv-contrib (xfeatures2d).");
-#endif
+            keep = 1;
         }
-        else
+        st.afterRatio += keep;
+
+        for (size_t n = 0; n < keep; ++n)
         {
-            throw invalid_argument("detKeypoints: unknown detectorType '" + detectorType + "'");
+            if (config_.mutual && reverseBest[m[n].trainIdx] != m[n].queryIdx)
+                continue;
+            ++st.afterMutual;
+            if (config_.maxDistance > 0.0f && m[n].distance > config_.maxDistance)
+                continue;
+            matches.push_back(m[n]);
         }
-        detector->detect(img, keypoints);
     }
+    st.survivors = matches.size();
+    st.filterMs  = ((double)cv::getTickCount() - t) / cv::getTickFrequency() * 1000.0;
+}
 
-    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
-    cout << detectorType << " detection with n=" << keypoints.size()
-         << " keypoints in " << 1000 * t << " ms" << endl;
+// ---------------------------------------------------------------------------
+// String entry points
+// ---------------------------------------------------------------------------
+void detKeypoints(vector<cv::KeyPoint> &keypoints, cv::Mat &img,
+                  const string &detectorType, bool bVis)
+{
+    KeypointDetector(FeatureRegistry::instance().detector(detectorType)).detect(img, keypoints);
 
     // visualize results
     if (bVis)
@@ -263,4 +695,23 @@ void detKeypoints(vector<cv::KeyPoint> &keypoints, cv::Mat &img,
         cv::imshow(windowName, visImage);
         cv::waitKey(0);
     }
-}
\ No newline at end of file
+}
+
+void descKeypoints(vector<cv::KeyPoint> &keypoints, cv::Mat &img,
+                   cv::Mat &descriptors, const string &descriptorType)
+{
+    KeypointDescriber(FeatureRegistry::instance().descriptor(descriptorType))
+        .describe(img, keypoints, descriptors);
+}
+
+void matchDescriptors(vector<cv::KeyPoint> &kPtsSource, vector<cv::KeyPoint> &kPtsRef,
+                      cv::Mat &descSource, cv::Mat &descRef,
+                      vector<cv::DMatch> &matches,
+                      const string &descriptorType, const string &matcherType,
+                      const string &selectorType, const MatchConfig &config,
+                      MatchStats *stats)
+{
+    FrameMatcher matcher(parseMatcherKind(matcherType), parseSelectorKind(selectorType),
+                         isBinaryDescriptor(descriptorType), config);
+    matcher.match(descSource, descRef, matches, stats);
+}
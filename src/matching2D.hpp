@@ -9,6 +9,8 @@
 #include <limits>
 #include <algorithm>
 #include <stdexcept>
+#include <string>
+#include <variant>
 
 #include <opencv2/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
@@ -32,12 +34,214 @@
 #endif
 
 #include "dataStructures.h"
+#include "featureRegistry.hpp"
+#include "hashMatcher.hpp"
+
+class ThreadPool;
+
+// ---------------------------------------------------------------------------
+// Algorithm selection. Detector and descriptor names are looked up in the
+// FeatureRegistry once per combination; matcher and selector names are
+// parsed into enums. The per-frame path only sees the resolved stages below.
+// ---------------------------------------------------------------------------
+enum class MatcherKind    { BF, BF_PAR, FLANN, HASH, MIH };
+enum class SelectorKind   { NN, KNN };
+
+// Throw std::invalid_argument on unknown names.
+MatcherKind    parseMatcherKind(const std::string &name);
+SelectorKind   parseSelectorKind(const std::string &name);
 
 // Returns true when the descriptor encodes binary patterns (Hamming norm).
 // Returns false for float-valued descriptors (L2 norm, e.g. SIFT).
+// Throws std::invalid_argument on unknown descriptorType.
 bool isBinaryDescriptor(const std::string &descriptorType);
 
-// Single entry point for all detectors: SHITOMASI, HARRIS, FAST, BRISK, ORB, AKAZE, SIFT.
+// Returns false when the matcher has no path for this descriptor norm and
+// FrameMatcher runs MAT_BF instead (MAT_MIH on float, MAT_HASH on binary).
+bool matcherApplies(MatcherKind matcher, bool binaryDescriptors);
+
+// Match filtering knobs. The defaults reproduce the original behaviour
+// (k = 2, ratio 0.8, no cross-check, no distance cutoff).
+struct MatchConfig
+{
+    float ratio       = 0.8f;  // SEL_KNN: keep best if best < ratio * second; >= 1 disables
+    int   k           = 2;     // SEL_KNN: neighbours retrieved per query
+    bool  mutual      = false; // keep i->j only if i is also j's nearest neighbour
+    float maxDistance = 0.0f;  // drop matches farther than this; 0 disables
+    int   hashCandidates = 8;  // MAT_HASH: rows re-ranked by exact L2 per query (>= k)
+    bool  measureRecall = false; // MAT_HASH: also run MAT_BF and report top-1 recall
+};
+
+// Cost and survivor count of each matching stage, for picking the cheapest
+// configuration that is good enough.
+struct MatchStats
+{
+    size_t candidates  = 0;    // matches proposed by the neighbour search
+    size_t afterRatio  = 0;
+    size_t afterMutual = 0;
+    size_t survivors   = 0;    // after the distance cutoff == matches.size()
+    double searchMs    = 0.0;  // neighbour search (including any distance matrix)
+    double filterMs    = 0.0;  // ratio / mutual / distance filtering
+    double recall      = -1.0; // MAT_HASH top-1 agreement with MAT_BF; < 0 if not measured
+    double exactMs     = 0.0;  // the MAT_BF search run for that (not in searchMs)
+};
+
+// Per-frame keypoint budget. Keeps matching cost bounded regardless of how
+// many points a detector returns.
+struct KeypointBudget
+{
+    size_t maxKeypoints = 0;  // 0 disables the budget
+    int    gridCols = 0;      // > 0 with gridRows: spread the budget over a grid
+    int    gridRows = 0;
+
+    bool enabled() const { return maxKeypoints > 0; }
+    bool gridded() const { return gridCols > 0 && gridRows > 0; }
+};
+
+// Keep at most budget.maxKeypoints keypoints, strongest response first,
+// using nth_element (O(n), order of the survivors is unspecified). With a
+// grid, `area` is split into gridCols x gridRows cells that each get an equal
+// share; budget left over by sparse cells goes to the strongest remaining
+// points anywhere.
+void retainBestKeypoints(std::vector<cv::KeyPoint> &keypoints, const KeypointBudget &budget,
+                         const cv::Rect &area);
+
+// Closed-loop detector threshold: hold the per-frame keypoint count near a
+// target. Deadband with hysteresis -- adjustment starts once the count is
+// more than `band` away from the target and continues until it is within
+// band / 2, so the threshold does not chatter on small fluctuations.
+struct ThresholdControl
+{
+    size_t targetKeypoints = 0;   // 0 disables the controller
+    double band    = 0.2;         // relative deadband around the target
+    double gain    = 0.5;         // threshold *= (count / target)^gain
+    double maxStep = 2.0;         // largest factor applied in one frame
+
+    bool enabled() const { return targetKeypoints > 0; }
+};
+
+class ThresholdController
+{
+  public:
+    // Throws std::invalid_argument on a negative band/gain or maxStep < 1.
+    ThresholdController(const ThresholdControl &control, const ThresholdRange &range);
+
+    // False when disabled or the detector has no adjustable threshold.
+    bool active() const { return control_.enabled() && range_.adjustable(); }
+
+    // Threshold for the next frame, given the current one and the number of
+    // keypoints it produced. Clamped to the detector's range.
+    double next(double threshold, size_t count);
+
+  private:
+    ThresholdControl control_;
+    ThresholdRange range_;
+    bool settling_ = false;
+};
+
+// ---------------------------------------------------------------------------
+// Resolved pipeline stages. Each is built once per detector/descriptor
+// combination from its registry entry: OpenCV algorithms are created in the
+// constructor and our own kernels (Shi-Tomasi, Harris) are concrete variant
+// alternatives, so a frame costs neither string compares nor a virtual call
+// for them.
+// ---------------------------------------------------------------------------
+class KeypointDetector
+{
+  public:
+    // Throws std::runtime_error if a contrib-only detector is missing.
+    explicit KeypointDetector(const DetectorInfo &info);
+
+    const std::string &name() const { return name_; }
+    const std::string &paramsTag() const { return params_; }
+
+    void detect(const cv::Mat &img, std::vector<cv::KeyPoint> &keypoints) const;
+
+    const ThresholdRange &thresholdRange() const { return range_; }
+    double threshold() const { return threshold_; }
+
+    // Rebuild the kernel at a new threshold (clamped to the range). Throws
+    // std::logic_error if the detector has no adjustable threshold.
+    void setThreshold(double threshold);
+
+  private:
+    std::string name_, params_;
+    ThresholdRange range_;
+    std::function<DetectorKernel(double)> createWithThreshold_;
+    double threshold_;
+    DetectorKernel kernel_;
+};
+
+class KeypointDescriber
+{
+  public:
+    // Throws std::runtime_error if a contrib-only descriptor is missing.
+    explicit KeypointDescriber(const DescriptorInfo &info);
+
+    const std::string &name() const { return name_; }
+    const std::string &paramsTag() const { return params_; }
+    bool isBinary() const { return normType_ == cv::NORM_HAMMING; }
+    size_t rowBytes() const;   // bytes per descriptor row
+
+    // May drop keypoints it cannot describe (e.g. too close to the border);
+    // returns how many. Descriptors are written into DescriptorArena blocks.
+    size_t describe(const cv::Mat &img, std::vector<cv::KeyPoint> &keypoints,
+                    cv::Mat &descriptors) const;
+
+    // Detect with the extractor's own algorithm and describe in the same pass,
+    // so its scale pyramid is built once. Only meaningful for fusable entries.
+    // A non-empty CV_8U mask restricts detection, and so description, to its
+    // non-zero pixels.
+    void detectAndDescribe(const cv::Mat &img, const cv::Mat &mask,
+                           std::vector<cv::KeyPoint> &keypoints, cv::Mat &descriptors) const;
+
+  private:
+    std::string name_, params_;
+    int normType_;
+    cv::Ptr<cv::Feature2D> extractor_;
+};
+
+class FrameMatcher
+{
+  public:
+    // Throws std::invalid_argument for an invalid config (k < 2 with an
+    // active ratio test, MAT_HASH with fewer candidates than k).
+    // MAT_BF_PAR spreads its query blocks over sharedThreadPool().
+    FrameMatcher(MatcherKind matcher, SelectorKind selector, bool binaryDescriptors,
+                 const MatchConfig &config = MatchConfig());
+    // Same, with the pool MAT_BF_PAR uses; null runs its blocks serially
+    // (e.g. from tasks that already occupy every core).
+    FrameMatcher(MatcherKind matcher, SelectorKind selector, bool binaryDescriptors,
+                 const MatchConfig &config, ThreadPool *pool);
+
+    // MAT_BF uses the padded-row kernels when both sides have that layout
+    // (the pipeline's descriptors, quantized SIFT included) and cv::BFMatcher
+    // otherwise; with config.mutual both directions are read from the same
+    // distances. Other matchers issue a reverse query for the mutual check. MAT_HASH
+    // prefilters float descriptors by sign hash (see HashPrefilterMatcher);
+    // binary descriptors already are hashes and go through MAT_BF. MAT_MIH
+    // is exact k-NN for binary descriptors by multi-index hashing (see
+    // MultiIndexHash); float descriptors go through MAT_BF. MAT_BF_PAR is
+    // exact brute force with query blocks spread over the matcher's pool, or
+    // run serially without one; do not call it from a task running on that pool.
+    void match(const cv::Mat &descSource, const cv::Mat &descRef,
+               std::vector<cv::DMatch> &matches, MatchStats *stats = nullptr) const;
+
+  private:
+    MatcherKind  matcherKind_;
+    SelectorKind selector_;
+    int          normType_;
+    MatchConfig  config_;
+    cv::Ptr<cv::DescriptorMatcher> matcher_;   // MAT_HASH: the exact fallback / reference
+    HashPrefilterMatcher hashMatcher_;
+    ThreadPool  *pool_;                        // MAT_BF_PAR query blocks; null = serial
+};
+
+// ---------------------------------------------------------------------------
+// String entry points for one-off calls (each resolves its stage per call).
+// ---------------------------------------------------------------------------
+
+// Single entry point for all registered detectors (see FeatureRegistry).
 // Throws std::invalid_argument on unknown detectorType,
 // std::runtime_error  if a contrib-only detector is missing.
 void detKeypoints(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img,
@@ -50,13 +254,16 @@ void descKeypoints(std::vector<cv::KeyPoint> &keypoints, cv::Mat &img,
                    cv::Mat &descriptors, const std::string &descriptorType);
 
 // Match descriptors between two frames.
-// Throws std::invalid_argument on unknown matcherType / selectorType.
+// Throws std::invalid_argument on unknown matcherType / selectorType or an
+// invalid config.
 void matchDescriptors(std::vector<cv::KeyPoint> &kPtsSource,
                       std::vector<cv::KeyPoint> &kPtsRef,
                       cv::Mat &descSource, cv::Mat &descRef,
                       std::vector<cv::DMatch> &matches,
                       const std::string &descriptorType,
                       const std::string &matcherType,
-                      const std::string &selectorType);
+                      const std::string &selectorType,
+                      const MatchConfig &config = MatchConfig(),
+                      MatchStats *stats = nullptr);
 
 #endif /* matching2D_hpp */
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "multiIndexHash.hpp"
+#include "descriptorArena.hpp"
+#include "descriptorDistance.hpp"
+
+using namespace std;
+
+static const int kWideFromRows = 4096;   // switch to 16-bit substrings
+
+// All values of a `bits`-wide substring, grouped by popcount: the XOR masks
+// that reach every value at exactly radius r from a query substring.
+static const vector<vector<unsigned>> &masksByWeight(int bits)
+{
+    static const auto build = [](int b) {
+        vector<vector<unsigned>> masks(b + 1);
+        for (unsigned v = 0; v < (1u << b); ++v)
+            masks[__builtin_popcount(v)].push_back(v);
+        return masks;
+    };
+    static const vector<vector<unsigned>> narrow = build(8), wide = build(16);
+    return bits == 8 ? narrow : wide;
+}
+
+MultiIndexHash::MultiIndexHash(const cv::Mat &descriptors)
+{
+    if (!descriptors.empty() && descriptors.type() != CV_8U)
+        throw invalid_argument("MultiIndexHash: binary (CV_8U) descriptors required");
+    padDescriptorRows(descriptors, data_);
+    if (data_.empty())
+        return;
+
+    const int rowBytes = data_.cols;
+    const int substringBytes = data_.rows >= kWideFromRows ? 2 : 1;
+    for (int offset = 0; offset < rowBytes; offset += substringBytes)
+    {
+        Table t;
+        t.byteOffset = offset;
+        t.bits = 8 * min(substringBytes, rowBytes - offset);   // AKAZE's odd last byte
+        t.offsets.assign((1u << t.bits) + 1, 0);
+        for (int r = 0; r < data_.rows; ++r)
+            ++t.offsets[substring(data_.ptr(r), t) + 1];
+        for (size_t v = 1; v < t.offsets.size(); ++v)
+            t.offsets[v] += t.offsets[v - 1];
+        t.ids.resize(data_.rows);
+        vector<int> fill(t.offsets.begin(), t.offsets.end() - 1);
+        for (int r = 0; r < data_.rows; ++r)
+            t.ids[fill[substring(data_.ptr(r), t)]++] = r;
+        tables_.push_back(std::move(t));
+    }
+}
+
+unsigned MultiIndexHash::substring(const uchar *row, const Table &table) const
+{
+    const uchar *p = row + table.byteOffset;
+    return table.bits == 8 ? p[0] : (unsigned)p[0] | ((unsigned)p[1] << 8);
+}
+
+void MultiIndexHash::knnSearch(const cv::Mat &query, int k, vector<vector<cv::DMatch>> &knn,
+                               size_t *verified) const
+{
+    knn.assign(query.rows, vector<cv::DMatch>());
+    if (verified)
+        *verified = 0;
+    if (query.empty() || data_.empty())
+        return;
+    if (query.type() != CV_8U || query.cols != data_.cols)
+        throw invalid_argument("MultiIndexHash::knnSearch: query rows differ from the index");
+
+    cv::Mat q;
+    padDescriptorRows(query, q);
+    const size_t bytes = data_.step[0];
+    const int m = (int)tables_.size();
+    const int maxBits = tables_.front().bits;
+    const size_t want = (size_t)min(k, data_.rows);
+
+    vector<int> seenBy(data_.rows, -1);   // query row that last verified each indexed row
+    for (int i = 0; i < q.rows; ++i)
+    {
+        const uchar *qrow = q.ptr(i);
+        vector<cv::DMatch> &best = knn[i];
+        auto consider = [&](int j) {
+            if (seenBy[j] == i)
+                return;
+            seenBy[j] = i;
+            if (verified)
+                ++*verified;
+            const float d = (float)hammingPadded(qrow, data_.ptr(j), bytes);
+            if (best.size() == want && d >= best.back().distance)
+                return;
+            cv::DMatch match(i, j, d);
+            best.insert(upper_bound(best.begin(), best.end(), match,
+                                    [](const cv::DMatch &a, const cv::DMatch &b) { return a.distance < b.distance; }),
+                        match);
+            if (best.size() > want)
+                best.pop_back();
+        };
+
+        for (int r = 0; r <= maxBits; ++r)
+        {
+            for (const Table &t : tables_)
+            {
+                if (r > t.bits)
+                    continue;
+                const unsigned value = substring(qrow, t);
+                for (unsigned mask : masksByWeight(t.bits)[r])
+                {
+                    const unsigned bucket = value ^ mask;
+                    for (int n = t.offsets[bucket]; n < t.offsets[bucket + 1]; ++n)
+                        consider(t.ids[n]);
+                }
+            }
+            // Every row within m * (r + 1) - 1 has now been verified.
+            if (best.size() == want && best.back().distance <= (float)(m * (r + 1) - 1))
+                break;
+        }
+    }
+}
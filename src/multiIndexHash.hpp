@@ -0,0 +1,53 @@
+#ifndef multiIndexHash_hpp
+#define multiIndexHash_hpp
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+// ---------------------------------------------------------------------------
+// Exact k-nearest-neighbour search in Hamming space by multi-index hashing
+// (Norouzi et al., MAT_MIH).
+//
+// Each binary descriptor is split into m byte-aligned substrings, and each
+// substring position gets a table from substring value to descriptor rows.
+// If two descriptors are within distance m * (r + 1) - 1, some substring
+// differs by at most r bits (pigeonhole), so probing every table with all
+// values within radius r of the query's substring finds them. The radius
+// grows until the k best verified distances are within that bound, which
+// makes the result exact -- the same neighbours as brute force -- while only
+// the rows that share a near substring are compared in full.
+//
+// Substrings are 8 bits wide for small sets and 16 bits from 4096 rows on
+// (roughly log2 of the set size, where MIH does least work).
+// ---------------------------------------------------------------------------
+class MultiIndexHash
+{
+  public:
+    // Index CV_8U descriptor rows; the tables are built here, once per frame.
+    // Throws std::invalid_argument for other types.
+    explicit MultiIndexHash(const cv::Mat &descriptors);
+
+    int rows() const { return data_.rows; }
+    int substrings() const { return (int)tables_.size(); }
+
+    // k nearest indexed rows of every query row (trainIdx), best first.
+    // `verified` (optional) receives the number of full distance computations.
+    void knnSearch(const cv::Mat &query, int k, std::vector<std::vector<cv::DMatch>> &knn,
+                   size_t *verified = nullptr) const;
+
+  private:
+    struct Table
+    {
+        int byteOffset, bits;        // substring position and width (8 or 16)
+        std::vector<int> offsets;    // 2^bits + 1 bucket starts into ids (CSR)
+        std::vector<int> ids;
+    };
+
+    unsigned substring(const uchar *row, const Table &table) const;
+
+    cv::Mat data_;                   // padded rows (see padDescriptorRows)
+    std::vector<Table> tables_;
+};
+
+#endif /* multiIndexHash_hpp */
@@ -0,0 +1,111 @@
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+#include "pipelineConfig.hpp"
+
+using namespace std;
+
+static string trim(const string &s)
+{
+    const size_t b = s.find_first_not_of(" \t\r");
+    if (b == string::npos)
+        return "";
+    const size_t e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+static string upper(string s)
+{
+    transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return (char)toupper(c); });
+    return s;
+}
+
+// Whole-string numeric parse; atof would silently accept "0.8x".
+template <class T>
+static T parseNumber(const string &key, const string &value, int line)
+{
+    istringstream in(value);
+    T v;
+    if (!(in >> v) || !(in >> ws).eof())
+        throw invalid_argument("loadPipelineConfig: line " + to_string(line) + ": bad value '"
+                               + value + "' for " + key);
+    return v;
+}
+
+void loadPipelineConfig(const string &path, PipelineConfig &config)
+{
+    ifstream in(path);
+    if (!in)
+        throw runtime_error("loadPipelineConfig: could not open '" + path + "'");
+
+    PipelineSettings &s = config.settings;
+    string raw;
+    for (int line = 1; getline(in, raw); ++line)
+    {
+        const string text = trim(raw.substr(0, raw.find('#')));
+        if (text.empty())
+            continue;
+        const size_t eq = text.find('=');
+        if (eq == string::npos)
+            throw invalid_argument("loadPipelineConfig: line " + to_string(line) + ": expected key = value");
+        const string key   = trim(text.substr(0, eq));
+        const string value = trim(text.substr(eq + 1));
+
+        if      (key == "detector")      config.detector = upper(value);
+        else if (key == "descriptor")    config.descriptor = upper(value);
+        else if (key == "matcher")       s.matcherType = upper(value);
+        else if (key == "selector")      s.selectorType = upper(value);
+        else if (key == "ratio")         s.matchConfig.ratio = parseNumber<float>(key, value, line);
+        else if (key == "knn_k")         s.matchConfig.k = parseNumber<int>(key, value, line);
+        else if (key == "mutual")        s.matchConfig.mutual = parseNumber<int>(key, value, line) != 0;
+        else if (key == "max_dist")      s.matchConfig.maxDistance = parseNumber<float>(key, value, line);
+        else if (key == "hash_candidates") s.matchConfig.hashCandidates = parseNumber<int>(key, value, line);
+        else if (key == "quantize")      s.bQuantizeDescriptors = parseNumber<int>(key, value, line) != 0;
+        else if (key == "max_keypoints") s.keypointBudget.maxKeypoints = parseNumber<size_t>(key, value, line);
+        else if (key == "target_keypoints") s.thresholdControl.targetKeypoints = parseNumber<size_t>(key, value, line);
+        else if (key == "target_band")   s.thresholdControl.band = parseNumber<double>(key, value, line);
+        else if (key == "fuse")          s.bFuseDetectDescribe = parseNumber<int>(key, value, line) != 0;
+        else if (key == "focus_on_vehicle") s.bFocusOnVehicle = parseNumber<int>(key, value, line) != 0;
+        else if (key == "grid")
+        {
+            if (sscanf(value.c_str(), "%dx%d", &s.keypointBudget.gridCols, &s.keypointBudget.gridRows) != 2)
+                throw invalid_argument("loadPipelineConfig: line " + to_string(line) + ": grid expects CxR");
+        }
+        else
+            throw invalid_argument("loadPipelineConfig: line " + to_string(line) + ": unknown key '" + key + "'");
+    }
+}
+
+void savePipelineConfig(const string &path, const PipelineConfig &config, const string &comment)
+{
+    ofstream out(path);
+    if (!out)
+        throw runtime_error("savePipelineConfig: could not write '" + path + "'");
+
+    istringstream lines(comment);
+    for (string l; getline(lines, l);)
+        out << "# " << l << "\n";
+
+    const PipelineSettings &s = config.settings;
+    if (!config.detector.empty())   out << "detector = " << config.detector << "\n";
+    if (!config.descriptor.empty()) out << "descriptor = " << config.descriptor << "\n";
+    out << "matcher = " << s.matcherType << "\n"
+        << "selector = " << s.selectorType << "\n"
+        << "ratio = " << s.matchConfig.ratio << "\n"
+        << "knn_k = " << s.matchConfig.k << "\n"
+        << "mutual = " << (s.matchConfig.mutual ? 1 : 0) << "\n"
+        << "max_dist = " << s.matchConfig.maxDistance << "\n"
+        << "hash_candidates = " << s.matchConfig.hashCandidates << "\n"
+        << "quantize = " << (s.bQuantizeDescriptors ? 1 : 0) << "\n"
+        << "max_keypoints = " << s.keypointBudget.maxKeypoints << "\n"
+        << "grid = " << s.keypointBudget.gridCols << "x" << s.keypointBudget.gridRows << "\n"
+        << "target_keypoints = " << s.thresholdControl.targetKeypoints << "\n"
+        << "target_band = " << s.thresholdControl.band << "\n"
+        << "fuse = " << (s.bFuseDetectDescribe ? 1 : 0) << "\n"
+        << "focus_on_vehicle = " << (s.bFocusOnVehicle ? 1 : 0) << "\n";
+    if (!out)
+        throw runtime_error("savePipelineConfig: write to '" + path + "' failed");
+}
@@ -0,0 +1,36 @@
+#ifndef pipelineConfig_hpp
+#define pipelineConfig_hpp
+
+#include <string>
+#include <stdexcept>
+
+#include "framePipeline.hpp"
+
+// ---------------------------------------------------------------------------
+// Pipeline configuration files (--config), as written by --autotune.
+//
+// Plain "key = value" lines; '#' starts a comment. Keys:
+//   detector, descriptor, matcher, selector,
+//   ratio, knn_k, mutual (0/1), max_dist, hash_candidates, quantize (0/1),
+//   max_keypoints, grid (CxR), target_keypoints, target_band, fuse (0/1),
+//   focus_on_vehicle (0/1)
+// Keys that are absent leave the current value alone, so later command-line
+// options still override a loaded file.
+// ---------------------------------------------------------------------------
+struct PipelineConfig
+{
+    std::string detector;       // empty: all detectors
+    std::string descriptor;     // empty: all descriptors
+    PipelineSettings settings;
+};
+
+// Throws std::runtime_error if the file cannot be read, and
+// std::invalid_argument on unknown keys or malformed values.
+void loadPipelineConfig(const std::string &path, PipelineConfig &config);
+
+// Throws std::runtime_error if the file cannot be written. `comment` lines
+// are written first, each prefixed with "# ".
+void savePipelineConfig(const std::string &path, const PipelineConfig &config,
+                        const std::string &comment = "");
+
+#endif /* pipelineConfig_hpp */
@@ -0,0 +1,395 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <future>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "pipelineRunners.hpp"
+#include "shmRing.hpp"
+#include "frameDump.hpp"
+
+using namespace std;
+
+// ---------------------------------------------------------------------------
+// Image loading
+// ---------------------------------------------------------------------------
+cv::Mat loadGrayscaleImage(const string &path)
+{
+    cv::Mat img = cv::imread(path);
+    if (img.empty())
+        throw runtime_error("loadGrayscaleImage: could not open '" + path + "'");
+    cv::Mat gray;
+    cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+    return gray;
+}
+
+// ---------------------------------------------------------------------------
+// One frame, under the scheduler if there is one. False if it was dropped.
+// ---------------------------------------------------------------------------
+static bool processFrame(FramePipeline &pipeline, FrameScheduler *scheduler,
+                         const cv::Mat &imgGray, size_t imgIndex, FrameResult &result,
+                         bool canDrop = true)
+{
+    if (!scheduler)
+    {
+        result = pipeline.process(imgGray, imgIndex);
+        return true;
+    }
+
+    const double t = (double)cv::getTickCount();
+    const FrameAction action = scheduler->plan(canDrop);
+    result = action == FrameAction::DROP
+        ? FrameResult()
+        : pipeline.process(imgGray, imgIndex, scheduler->shortcuts(action));
+    scheduler->record(imgIndex, pipeline.stages().detector.name(),
+                      pipeline.stages().describer.name(), action, result, elapsedMs(t));
+    return action != FrameAction::DROP;
+}
+
+// ---------------------------------------------------------------------------
+// Full pipeline for one detector + descriptor combination.
+// ---------------------------------------------------------------------------
+vector<FrameResult> runImageSequence(FramePipeline &pipeline, const ImageSequence &sequence,
+                                     FrameScheduler *scheduler)
+{
+    vector<FrameResult> results;
+    for (size_t imgIndex = 0;
+         imgIndex <= (size_t)(sequence.endIndex - sequence.startIndex);
+         ++imgIndex)
+    {
+        /* --- 1. Load image --- */
+        ostringstream num;
+        num << setfill('0') << setw(sequence.fillWidth) << sequence.startIndex + (int)imgIndex;
+        const string imgPath = sequence.basePath + sequence.prefix + num.str() + sequence.fileType;
+
+        cv::Mat imgGray = loadGrayscaleImage(imgPath); // Load a single image as grayscale; throws std::runtime_error on failure
+
+        FrameResult result;
+        if (processFrame(pipeline, scheduler, imgGray, imgIndex, result))
+            results.push_back(result);
+    } // eof image loop
+    return results;
+}
+
+// ---------------------------------------------------------------------------
+// Synchronised multi-camera run on a shared pool
+// ---------------------------------------------------------------------------
+CameraSource kittiCamera(int index)
+{
+    ostringstream name;
+    name << "image_" << setfill('0') << setw(2) << index;
+    CameraSource camera;
+    camera.name = name.str();
+    camera.sequence.prefix = "KITTI/2011_09_26/" + camera.name + "/data/000000";
+    return camera;
+}
+
+MultiCameraReport runMultiCamera(const vector<CameraSource> &cameras,
+                                 const string &detectorType,
+                                 const string &descriptorType,
+                                 const PipelineSettings &settings,
+                                 const PipelineOutputs &outputs,
+                                 ThreadPool &pool)
+{
+    if (outputs.keypointBinLog || outputs.matchBinLog || outputs.keypointDump
+        || outputs.matchDump || outputs.frameDump || outputs.cache)
+        throw invalid_argument("runMultiCamera: binary logs, --dump and --cache are single-camera only");
+
+    // One pipeline per camera, each writing CSV rows to its own buffer.
+    const size_t n = cameras.size();
+    vector<ostringstream> keypointRows(n), matchRows(n);
+    vector<unique_ptr<FramePipeline>> pipelines;
+    MultiCameraReport report;
+    for (size_t c = 0; c < n; ++c)
+    {
+        PipelineSettings s = settings;
+        s.imageOutputDir += cameras[c].name + "_";
+        s.bParallelMatch  = false;   // camera tasks already fill the cores; no nested pool
+        PipelineOutputs o = outputs;
+        o.keypointLog = &keypointRows[c];
+        o.matchLog    = &matchRows[c];
+        pipelines.emplace_back(new FramePipeline(detectorType, descriptorType, s, o));
+
+        CameraTiming timing;
+        timing.name = cameras[c].name;
+        timing.cpu  = pool.pinnedCpu(c % pool.size());
+        report.cameras.push_back(timing);
+    }
+
+    // OpenCV's own worker threads would compete with the pool's.
+    struct CvThreadsGuard
+    {
+        int saved = cv::getNumThreads();
+        CvThreadsGuard() { cv::setNumThreads(1); }
+        ~CvThreadsGuard() { cv::setNumThreads(saved); }
+    } cvThreads;
+
+    size_t numFrames = 0;
+    for (const auto &cam : cameras)
+        numFrames = max(numFrames, (size_t)(cam.sequence.endIndex - cam.sequence.startIndex + 1));
+
+    const double wall = (double)cv::getTickCount();
+    for (size_t imgIndex = 0; imgIndex < numFrames; ++imgIndex)
+    {
+        vector<future<void>> done;
+        for (size_t c = 0; c < n; ++c)
+        {
+            const ImageSequence &seq = cameras[c].sequence;
+            if (imgIndex > (size_t)(seq.endIndex - seq.startIndex))
+                continue;
+            done.push_back(pool.submitTo(c % pool.size(), [&, c, imgIndex] {
+                const double t = (double)cv::getTickCount();
+                ostringstream num;
+                num << setfill('0') << setw(seq.fillWidth) << seq.startIndex + (int)imgIndex;
+                cv::Mat imgGray = loadGrayscaleImage(seq.basePath + seq.prefix + num.str() + seq.fileType);
+                pipelines[c]->process(imgGray, imgIndex);
+                report.cameras[c].busyMs += elapsedMs(t);
+                ++report.cameras[c].frames;
+            }));
+        }
+
+        // Every task references this frame's state: wait for all before rethrowing.
+        for (auto &f : done)
+            f.wait();
+        for (auto &f : done)
+            f.get();
+
+        for (size_t c = 0; c < n; ++c)
+        {
+            if (outputs.keypointLog) *outputs.keypointLog << keypointRows[c].str();
+            if (outputs.matchLog)    *outputs.matchLog    << matchRows[c].str();
+            keypointRows[c].str("");
+            matchRows[c].str("");
+        }
+    }
+    report.wallMs = elapsedMs(wall);
+    for (const auto &cam : report.cameras)
+        report.frames += cam.frames;
+    return report;
+}
+
+void printMultiCameraReport(ostream &out, const MultiCameraReport &report)
+{
+    out << "\n=== Multi-Camera Throughput ===\n";
+    for (const auto &cam : report.cameras)
+    {
+        const double msPerFrame = cam.frames ? cam.busyMs / (double)cam.frames : 0.0;
+        out << cam.name << ": " << cam.frames << " frames, " << msPerFrame << " ms/frame, "
+            << (msPerFrame > 0.0 ? 1000.0 / msPerFrame : 0.0) << " fps"
+            << (cam.cpu >= 0 ? " (CPU " + to_string(cam.cpu) + ")" : string()) << "\n";
+    }
+    out << "Aggregate: " << report.frames << " frames in " << report.wallMs << " ms, "
+        << (report.wallMs > 0.0 ? 1000.0 * (double)report.frames / report.wallMs : 0.0)
+        << " frames/s\n";
+}
+
+// ---------------------------------------------------------------------------
+// Stereo: temporal matching per side plus row-banded left/right matching
+// ---------------------------------------------------------------------------
+void runStereo(const CameraSource &left, const CameraSource &right,
+               const string &detectorType, const string &descriptorType,
+               const PipelineSettings &settings, const PipelineOutputs &outputs,
+               const StereoConfig &stereo, ostream *stereoLog)
+{
+    PipelineSettings leftSettings = settings, rightSettings = settings;
+    leftSettings.imageOutputDir  += left.name + "_";
+    rightSettings.imageOutputDir += right.name + "_";
+    rightSettings.bFocusOnVehicle = false;
+    // Per-frame logs and dumps have no camera column: they describe the left side.
+    PipelineOutputs rightOutputs;
+    rightOutputs.imageWriter = outputs.imageWriter;
+    rightOutputs.cache       = outputs.cache;
+    FramePipeline leftPipeline(detectorType, descriptorType, leftSettings, outputs);
+    FramePipeline rightPipeline(detectorType, descriptorType, rightSettings, rightOutputs);
+    const StereoMatcher matcher(leftPipeline.stages().describer.isBinary(), stereo);
+
+    const ImageSequence &ls = left.sequence, &rs = right.sequence;
+    const int numFrames = min(ls.endIndex - ls.startIndex, rs.endIndex - rs.startIndex) + 1;
+    for (int imgIndex = 0; imgIndex < numFrames; ++imgIndex)
+    {
+        ostringstream ln, rn;
+        ln << setfill('0') << setw(ls.fillWidth) << ls.startIndex + imgIndex;
+        rn << setfill('0') << setw(rs.fillWidth) << rs.startIndex + imgIndex;
+        leftPipeline.process(loadGrayscaleImage(ls.basePath + ls.prefix + ln.str() + ls.fileType), imgIndex);
+        rightPipeline.process(loadGrayscaleImage(rs.basePath + rs.prefix + rn.str() + rs.fileType), imgIndex);
+
+        const DataFrame &l = leftPipeline.buffer().back(), &r = rightPipeline.buffer().back();
+        vector<StereoMatch> matches;
+        StereoStats stats;
+        matcher.match(l.keypoints, l.descriptors, r.keypoints, r.descriptors, matches, &stats);
+
+        // Median depth of the (ROI) matches approximates the distance to the vehicle ahead.
+        vector<float> depths;
+        for (const auto &m : matches)
+            depths.push_back(m.depthM);
+        float medianDepth = 0.f, minDepth = 0.f;
+        if (!depths.empty())
+        {
+            nth_element(depths.begin(), depths.begin() + depths.size() / 2, depths.end());
+            medianDepth = depths[depths.size() / 2];
+            minDepth    = *min_element(depths.begin(), depths.end());
+        }
+
+        if (stereoLog)
+            *stereoLog << imgIndex << "," << detectorType << "," << descriptorType << ","
+                       << matches.size() << "," << medianDepth << "," << minDepth << ","
+                       << stats.comparisons << "," << stats.bruteForce << "," << stats.matchMs << "\n";
+        cout << "Stereo " << imgIndex << " - " << detectorType << "/" << descriptorType << ": "
+             << matches.size() << " matches, median depth " << medianDepth << " m, "
+             << stats.comparisons << " of " << stats.bruteForce << " pairs compared in "
+             << stats.matchMs << " ms\n";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Stream ingest: raw frames from stdin/FIFO, one result record per frame.
+// ---------------------------------------------------------------------------
+void runStream(FramePipeline &pipeline,
+               const string &streamInput,
+               const RawFrameFormat &frameFormat,
+               RecordFormat recordFormat,
+               ostream &records,
+               FrameScheduler *scheduler)
+{
+    // One recycled slot per buffered frame keeps the previous image intact.
+    RawFrameReader reader(streamInput, frameFormat, pipeline.settings().dataBufferSize);
+
+    writeStreamHeader(records, recordFormat);
+    cv::Mat imgGray;
+    for (size_t imgIndex = 0; reader.next(imgGray); ++imgIndex)
+    {
+        FrameResult result;
+        if (processFrame(pipeline, scheduler, imgGray, imgIndex, result))
+            writeStreamRecord(records, recordFormat, imgIndex, result);
+        else
+            reader.reuseLast();   // keep the rotation on the buffered frames' slots
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Shared-memory ingest
+// ---------------------------------------------------------------------------
+void runShm(FramePipeline &pipeline, const string &shmName, FrameScheduler *scheduler)
+{
+    const PipelineSettings &settings = pipeline.settings();
+    ShmRing frames(shmName + ".frames", ShmRing::Mode::OPEN);
+    ShmRing results(shmName + ".results", ShmRing::Mode::OPEN);
+
+    // Close the result ring on every exit, errors included, so the producer
+    // stops waiting for results instead of blocking forever.
+    struct ResultsGuard
+    {
+        ShmRing &ring;
+        ~ResultsGuard() { ring.close(); }
+    } resultsGuard{results};
+
+    // Buffered frames keep their slots, so the producer needs at least one more.
+    if (frames.slotCount() <= (uint32_t)settings.dataBufferSize)
+        throw runtime_error("runShm: frame ring needs more than "
+                            + to_string(settings.dataBufferSize) + " slots");
+    if (results.slotBytes() < sizeof(StreamRecord))
+        throw runtime_error("runShm: result ring slots are too small for a StreamRecord");
+
+    const uint8_t *slot;
+    while ((slot = frames.acquire()) != nullptr)
+    {
+        ShmFrameHeader hdr;
+        memcpy(&hdr, slot, sizeof(hdr));
+        if (hdr.stride < hdr.width
+            || kShmPixelOffset + (size_t)hdr.stride * hdr.height > frames.slotBytes())
+            throw runtime_error("runShm: frame " + to_string(hdr.frameIndex)
+                                + " does not fit its slot");
+
+        // Zero-copy: the Mat header points straight into the shared slot.
+        cv::Mat imgGray((int)hdr.height, (int)hdr.width, CV_8UC1,
+                        const_cast<uint8_t *>(slot + kShmPixelOffset), hdr.stride);
+
+        // A dropped frame keeps its slot until the next processed one (slots are
+        // released oldest first), so only drop while the ring has a spare slot.
+        const bool canDrop = frames.held() + 1 < frames.slotCount();
+        FrameResult result;
+        if (!processFrame(pipeline, scheduler, imgGray, hdr.frameIndex, result, canDrop))
+            continue;
+
+        // Only the newest frame's image is needed again (as "previous" for drawing).
+        while (frames.held() > (uint64_t)max(1, settings.dataBufferSize - 1))
+            frames.release();
+
+        const StreamRecord rec = makeStreamRecord(hdr.frameIndex, result);
+        memcpy(results.claim(), &rec, sizeof(rec));
+        results.publish();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Offline replay (matching only)
+// ---------------------------------------------------------------------------
+void runReplay(const string &dumpPath,
+               const string &onlyDetector,
+               const string &onlyDescriptor,
+               const PipelineSettings &settings,
+               const PipelineOutputs &outputs)
+{
+    FrameDumpReader dump(dumpPath);
+    cout << "Replaying " << dump.size() << " frames from " << dumpPath << endl;
+
+    // A sweep dump interleaves combinations; remember each one's last frame
+    // and resolve its matcher once.
+    map<string, size_t> previousFrame;
+    map<string, FrameMatcher> matchers;
+    size_t pairs = 0, totalMatches = 0;
+    double totalMs = 0.0;
+
+    for (size_t i = 0; i < dump.size(); ++i)
+    {
+        const string det  = dump.detectorType(i);
+        const string desc = dump.descriptorType(i);
+        if ((!onlyDetector.empty() && det != onlyDetector)
+            || (!onlyDescriptor.empty() && desc != onlyDescriptor))
+            continue;
+
+        const string key = det + "+" + desc;
+        auto prev = previousFrame.find(key);
+        if (prev != previousFrame.end())
+        {
+            auto matcher = matchers.find(key);
+            if (matcher == matchers.end())
+                matcher = matchers.emplace(key, FrameMatcher(parseMatcherKind(settings.matcherType),
+                                                             parseSelectorKind(settings.selectorType),
+                                                             isBinaryDescriptor(desc),
+                                                             settings.matchConfig)).first;
+            cv::Mat descPrev = dump.descriptors(prev->second);
+            cv::Mat descCurr = dump.descriptors(i);
+
+            vector<cv::DMatch> matches;
+            MatchStats stats;
+            const double t = (double)cv::getTickCount();
+            if (!descPrev.empty() && !descCurr.empty())
+                matcher->second.match(descPrev, descCurr, matches, &stats);
+            const double matchMs = elapsedMs(t);
+
+            const size_t imgIndex = dump.chunk(i).imageIndex;
+            logMatches(outputs, imgIndex, det, desc, matches, matchMs);
+            cout << "Image " << imgIndex << " - " << det << "/" << desc << ": "
+                 << matches.size() << " matches (dumped " << dump.chunk(i).numMatches
+                 << ") in " << matchMs << " ms\n";
+            logMatchStats(stats);
+
+            ++pairs;
+            totalMatches += matches.size();
+            totalMs += matchMs;
+        }
+        previousFrame[key] = i;
+    }
+
+    cout << "\n=== Replay Complete ===\n"
+         << "Frame pairs  : " << pairs << "\n";
+    if (pairs)
+        cout << "Mean matches : " << (double)totalMatches / pairs << "\n"
+             << "Mean match ms: " << totalMs / pairs << "\n";
+}
@@ -0,0 +1,120 @@
+#ifndef pipelineRunners_hpp
+#define pipelineRunners_hpp
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdexcept>
+
+#include "framePipeline.hpp"
+#include "rawFrameStream.hpp"
+#include "frameScheduler.hpp"
+#include "threadPool.hpp"
+#include "stereoMatcher.hpp"
+
+// ---------------------------------------------------------------------------
+// Frame sources that drive a FramePipeline. Each runs to the end of its
+// input and throws std::runtime_error on I/O failures. With a scheduler,
+// every frame is planned against its deadline and may be degraded or
+// dropped; dropped frames produce no record.
+// ---------------------------------------------------------------------------
+
+// Numbered image files: basePath + prefix + zero-padded index + fileType.
+// The defaults are the 10 bundled KITTI frames.
+struct ImageSequence
+{
+    std::string basePath   = "../images/";
+    std::string prefix     = "KITTI/2011_09_26/image_00/data/000000";
+    std::string fileType   = ".png";
+    int         startIndex = 0;
+    int         endIndex   = 9;    // 10 images total
+    int         fillWidth  = 4;
+};
+
+// One camera of a synchronised rig, e.g. KITTI image_00..image_03.
+struct CameraSource
+{
+    std::string   name;       // "image_00"; also prefixes its match images
+    ImageSequence sequence;
+};
+
+// The bundled KITTI frames of camera image_0<index>.
+CameraSource kittiCamera(int index);
+
+// Per-camera and aggregate throughput of runMultiCamera.
+struct CameraTiming
+{
+    std::string name;
+    size_t frames = 0;
+    double busyMs = 0.0;      // load + process, summed over frames
+    int    cpu    = -1;       // CPU its worker is pinned to, -1 if unpinned
+};
+
+struct MultiCameraReport
+{
+    std::vector<CameraTiming> cameras;
+    size_t frames = 0;        // over all cameras
+    double wallMs = 0.0;
+};
+
+// Load a single image as grayscale; throws std::runtime_error on failure.
+cv::Mat loadGrayscaleImage(const std::string &path);
+
+// Full pipeline over one image sequence. Returns the results of the frames
+// that were processed (dropped frames are left out).
+std::vector<FrameResult> runImageSequence(FramePipeline &pipeline, const ImageSequence &sequence,
+                                          FrameScheduler *scheduler = nullptr);
+
+// Synchronised multi-camera run: frame i of every camera is processed
+// concurrently on the pool (camera c always on worker c % pool.size()), and
+// frame i + 1 starts once all cameras are done with frame i. Each camera has
+// its own FramePipeline, so buffers and detector state are independent.
+// CSV rows are buffered per camera and appended in camera order after each
+// frame; binary logs, dumps and the cache are not shared across threads and
+// must be null. Throws std::invalid_argument for shared sinks, and rethrows
+// the first camera's error (e.g. missing images) once the frame is done.
+MultiCameraReport runMultiCamera(const std::vector<CameraSource> &cameras,
+                                 const std::string &detectorType,
+                                 const std::string &descriptorType,
+                                 const PipelineSettings &settings,
+                                 const PipelineOutputs &outputs,
+                                 ThreadPool &pool);
+
+// Per-camera frames, ms/frame and fps, then aggregate frames/s.
+void printMultiCameraReport(std::ostream &out, const MultiCameraReport &report);
+
+// Stereo run over a rectified left/right pair (KITTI image_00 / image_01).
+// Each side runs its own FramePipeline with the usual temporal matching; the
+// right side skips the vehicle ROI, since the vehicle sits up to
+// maxDisparity pixels further left there, and only the left side writes the
+// per-frame logs and dumps. Left and right keypoints of every frame are then
+// matched with StereoMatcher and one row per frame goes to `stereoLog`:
+// ImageIndex,DetectorType,DescriptorType,NumMatches,MedianDepthM,MinDepthM,
+// Comparisons,BruteForce,MatchMs. Throws like runImageSequence.
+void runStereo(const CameraSource &left, const CameraSource &right,
+               const std::string &detectorType, const std::string &descriptorType,
+               const PipelineSettings &settings, const PipelineOutputs &outputs,
+               const StereoConfig &stereo, std::ostream *stereoLog);
+
+// Stream ingest: raw frames from a file, FIFO or "-" (stdin), one result
+// record per frame written to `records`.
+void runStream(FramePipeline &pipeline, const std::string &streamInput,
+               const RawFrameFormat &frameFormat, RecordFormat recordFormat,
+               std::ostream &records, FrameScheduler *scheduler = nullptr);
+
+// Shared-memory ingest: frames are processed in place inside the producer's
+// "<name>.frames" ring and one StreamRecord per frame goes back through
+// "<name>.results". Start kitti_shm_producer (or the capture process) first.
+void runShm(FramePipeline &pipeline, const std::string &shmName,
+            FrameScheduler *scheduler = nullptr);
+
+// Offline replay: reuse keypoints/descriptors from a --dump file and run only
+// the matching stage, so matcher settings can be swept without re-detecting.
+// Empty onlyDetector / onlyDescriptor replay every combination in the dump.
+void runReplay(const std::string &dumpPath,
+               const std::string &onlyDetector,
+               const std::string &onlyDescriptor,
+               const PipelineSettings &settings,
+               const PipelineOutputs &outputs);
+
+#endif /* pipelineRunners_hpp */
@@ -0,0 +1,122 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "rawFrameStream.hpp"
+
+using namespace std;
+
+// ---------------------------------------------------------------------------
+// RawFrameReader
+// ---------------------------------------------------------------------------
+RawFrameReader::RawFrameReader(const string &path, const RawFrameFormat &format, int numSlots)
+    : fd_(-1), ownsFd_(false), format_(format)
+{
+    if (format_.width <= 0 || format_.height <= 0)
+        throw invalid_argument("RawFrameReader: width and height must be positive");
+    if (format_.stride != 0 && format_.stride < format_.width)
+        throw invalid_argument("RawFrameReader: stride must be >= width");
+    if (numSlots < 1)
+        throw invalid_argument("RawFrameReader: need at least one frame slot");
+
+    if (path.empty() || path == "-")
+    {
+        fd_ = STDIN_FILENO;
+    }
+    else
+    {
+        // Opening a FIFO blocks until the producer connects, which is what we want.
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0)
+            throw runtime_error("RawFrameReader: could not open '" + path + "': " + strerror(errno));
+        ownsFd_ = true;
+    }
+
+    slots_.assign((size_t)numSlots, vector<uchar>(format_.frameBytes()));
+}
+
+RawFrameReader::~RawFrameReader()
+{
+    if (ownsFd_)
+        ::close(fd_);
+}
+
+bool RawFrameReader::next(cv::Mat &frame)
+{
+    vector<uchar> &slot = slots_[nextSlot_];
+    const size_t want = slot.size();
+    size_t got = 0;
+
+    // Pipes deliver partial reads; keep going until a whole frame has arrived.
+    while (got < want)
+    {
+        ssize_t n = ::read(fd_, slot.data() + got, want - got);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            throw runtime_error(string("RawFrameReader: read failed: ") + strerror(errno));
+        }
+        if (n == 0)
+        {
+            if (got == 0) return false;
+            throw runtime_error("RawFrameReader: stream ended inside a frame ("
+                                + to_string(got) + " of " + to_string(want) + " bytes)");
+        }
+        got += (size_t)n;
+    }
+
+    frame = cv::Mat(format_.height, format_.width, CV_8UC1, slot.data(), format_.rowBytes());
+    nextSlot_ = (nextSlot_ + 1) % slots_.size();
+    return true;
+}
+
+void RawFrameReader::reuseLast()
+{
+    nextSlot_ = (nextSlot_ + slots_.size() - 1) % slots_.size();
+}
+
+// ---------------------------------------------------------------------------
+// Result records
+// ---------------------------------------------------------------------------
+RecordFormat parseRecordFormat(const string &name)
+{
+    if (name == "TEXT")   return RecordFormat::TEXT;
+    if (name == "BINARY") return RecordFormat::BINARY;
+    throw invalid_argument("parseRecordFormat: unknown record format '" + name + "'");
+}
+
+StreamRecord makeStreamRecord(size_t frameIndex, const FrameResult &result)
+{
+    StreamRecord rec;
+    rec.frameIndex   = (uint32_t)frameIndex;
+    rec.numKeypoints = (uint32_t)result.numKeypoints;
+    rec.numMatches   = (uint32_t)result.numMatches;
+    rec.detectMs     = (float)result.detectMs;
+    rec.describeMs   = (float)result.describeMs;
+    rec.matchMs      = (float)result.matchMs;
+    return rec;
+}
+
+void writeStreamHeader(ostream &out, RecordFormat format)
+{
+    if (format == RecordFormat::TEXT)
+        out << "Frame,NumKeypoints,NumMatches,DetectMs,DescribeMs,MatchMs\n";
+}
+
+void writeStreamRecord(ostream &out, RecordFormat format,
+                       size_t frameIndex, const FrameResult &result)
+{
+    if (format == RecordFormat::BINARY)
+    {
+        const StreamRecord rec = makeStreamRecord(frameIndex, result);
+        out.write(reinterpret_cast<const char *>(&rec), sizeof(rec));
+    }
+    else
+    {
+        out << frameIndex << "," << result.numKeypoints << "," << result.numMatches
+            << "," << result.detectMs << "," << result.describeMs << "," << result.matchMs << "\n";
+    }
+    // Downstream filters want each frame as soon as it is done.
+    out.flush();
+}
@@ -0,0 +1,85 @@
+#ifndef rawFrameStream_hpp
+#define rawFrameStream_hpp
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+#include <stdexcept>
+
+#include <opencv2/core.hpp>
+
+#include "dataStructures.h"
+
+// Geometry of one raw 8-bit grayscale frame on the wire.
+// stride is the number of bytes per row (>= width); 0 means "same as width".
+struct RawFrameFormat
+{
+    int width  = 0;
+    int height = 0;
+    int stride = 0;
+
+    size_t rowBytes()   const { return (size_t)(stride > 0 ? stride : width); }
+    size_t frameBytes() const { return rowBytes() * (size_t)height; }
+};
+
+// How per-frame results are written to stdout in stream mode.
+enum class RecordFormat
+{
+    TEXT,   // one comma-separated line per frame, preceded by a header line
+    BINARY  // one fixed-size StreamRecord per frame, no header
+};
+
+// Fixed-width little-endian record emitted per frame in RecordFormat::BINARY.
+struct StreamRecord
+{
+    uint32_t frameIndex;
+    uint32_t numKeypoints;
+    uint32_t numMatches;
+    float    detectMs;
+    float    describeMs;
+    float    matchMs;
+};
+static_assert(sizeof(StreamRecord) == 24, "StreamRecord must stay packed for consumers");
+
+// Reads fixed-size raw frames from stdin ("-") or a file/FIFO with read(2)
+// straight into a small ring of recycled buffers. Each returned cv::Mat is a
+// header over one of those buffers (no copy); it stays valid until numSlots
+// further frames have been read, so numSlots must cover the DataFrame buffer.
+class RawFrameReader
+{
+  public:
+    // Throws std::invalid_argument on a bad format, std::runtime_error if the
+    // input cannot be opened.
+    RawFrameReader(const std::string &path, const RawFrameFormat &format, int numSlots);
+    ~RawFrameReader();
+
+    RawFrameReader(const RawFrameReader &) = delete;
+    RawFrameReader &operator=(const RawFrameReader &) = delete;
+
+    // Returns false on a clean end-of-stream between frames.
+    // Throws std::runtime_error on a read error or a truncated frame.
+    bool next(cv::Mat &frame);
+
+    // Hand the last frame's slot back: the next read overwrites it instead of
+    // the oldest slot. For frames that were dropped, not buffered.
+    void reuseLast();
+
+  private:
+    int fd_;
+    bool ownsFd_;
+    RawFrameFormat format_;
+    std::vector<std::vector<uchar>> slots_;
+    size_t nextSlot_ = 0;
+};
+
+// Parse "text" / "binary"; throws std::invalid_argument otherwise.
+RecordFormat parseRecordFormat(const std::string &name);
+
+StreamRecord makeStreamRecord(size_t frameIndex, const FrameResult &result);
+
+void writeStreamHeader(std::ostream &out, RecordFormat format);
+void writeStreamRecord(std::ostream &out, RecordFormat format,
+                       size_t frameIndex, const FrameResult &result);
+
+#endif /* rawFrameStream_hpp */
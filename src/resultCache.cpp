@@ -0,0 +1,265 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <filesystem>
+#include <unistd.h>
+
+#include "resultCache.hpp"
+#include "frameDump.hpp"   // DumpKeyPoint
+
+using namespace std;
+
+// Bump when the meaning of a cached entry changes (e.g. ROI filtering rules).
+static const char *kCacheFormatVersion = "ftcache-2";
+
+static const char kKeypointMagic[8]   = {'F', 'T', 'C', 'K', 'P', 'T', '1', '\0'};
+static const char kDescriptorMagic[8] = {'F', 'T', 'C', 'D', 'S', 'C', '1', '\0'};
+
+struct CacheEntryHeader
+{
+    char     magic[8];
+    uint32_t numKeypoints;
+    int32_t  descType;      // -1 for keypoint-only entries
+    uint32_t descCols;
+    uint32_t descRowBytes;
+};
+
+// ---------------------------------------------------------------------------
+// 128-bit content hash (two independent 64-bit lanes, word at a time).
+// Not cryptographic -- the cache only has to tell honest inputs apart.
+// ---------------------------------------------------------------------------
+namespace
+{
+class ContentHasher
+{
+  public:
+    void update(const void *data, size_t n)
+    {
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        for (; n >= 8; p += 8, n -= 8)
+        {
+            uint64_t w;
+            memcpy(&w, p, 8);
+            mix(w);
+        }
+        uint64_t tail = 0;
+        memcpy(&tail, p, n);
+        mix(tail ^ ((uint64_t)n << 56));
+    }
+
+    void update(const string &s)
+    {
+        const uint64_t len = s.size();
+        update(&len, sizeof(len)); // length prefix keeps ("ab","c") != ("a","bc")
+        update(s.data(), s.size());
+    }
+
+    template <class T>
+    void updateValue(const T &v) { update(&v, sizeof(v)); }
+
+    string hex() const
+    {
+        ostringstream ss;
+        ss << std::hex << setfill('0') << setw(16) << finalize(a_ ^ b_) << setw(16) << finalize(b_ + a_);
+        return ss.str();
+    }
+
+  private:
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    // splitmix64 finaliser for full avalanche of the lane state.
+    static uint64_t finalize(uint64_t x)
+    {
+        x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27; x *= 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    void mix(uint64_t w)
+    {
+        a_ = rotl(a_ ^ w, 31) * 0x9E3779B97F4A7C15ull;
+        b_ = (rotl(b_ + w, 27) ^ a_) * 0xC2B2AE3D27D4EB4Full;
+    }
+
+    uint64_t a_ = 0x243F6A8885A308D3ull;
+    uint64_t b_ = 0x13198A2E03707344ull;
+};
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Keys
+// ---------------------------------------------------------------------------
+ResultCache::ResultCache(const string &dir) : dir_(dir)
+{
+    error_code ec;
+    filesystem::create_directories(dir_, ec);
+    if (ec)
+        throw runtime_error("ResultCache: could not create '" + dir_ + "': " + ec.message());
+}
+
+string ResultCache::detectionKey(const cv::Mat &img, const string &detectorType,
+                                 const string &detectorParams, const cv::Rect &roi) const
+{
+    ContentHasher h;
+    h.update(string(kCacheFormatVersion));
+    h.update(string(CV_VERSION));
+    h.update(detectorType);
+    h.update(detectorParams);
+    h.updateValue(roi.x); h.updateValue(roi.y);
+    h.updateValue(roi.width); h.updateValue(roi.height);
+
+    const int type = img.type();
+    h.updateValue(img.rows); h.updateValue(img.cols); h.updateValue(type);
+    const size_t rowBytes = (size_t)img.cols * img.elemSize();
+    for (int r = 0; r < img.rows; ++r)  // row by row: strided frames hash like packed ones
+        h.update(img.ptr(r), rowBytes);
+    return h.hex();
+}
+
+string ResultCache::descriptionKey(const string &detectionKey, const string &descriptorType,
+                                   const string &descriptorParams) const
+{
+    ContentHasher h;
+    h.update(detectionKey);
+    h.update(descriptorType);
+    h.update(descriptorParams);
+    return h.hex();
+}
+
+string ResultCache::entryPath(const string &key, const char *ext) const
+{
+    return dir_ + "/" + key.substr(0, 2) + "/" + key.substr(2) + ext;
+}
+
+// ---------------------------------------------------------------------------
+// Entry I/O
+// ---------------------------------------------------------------------------
+static bool readEntry(const string &path, const char (&magic)[8], vector<char> &bytes,
+                      CacheEntryHeader &hdr)
+{
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in)
+        return false;
+    bytes.resize((size_t)in.tellg());
+    in.seekg(0);
+    if (!in.read(bytes.data(), (streamsize)bytes.size()) || bytes.size() < sizeof(hdr))
+        return false;
+    memcpy(&hdr, bytes.data(), sizeof(hdr));
+    const size_t expected = sizeof(hdr) + (size_t)hdr.numKeypoints
+                            * (sizeof(DumpKeyPoint) + hdr.descRowBytes);
+    return memcmp(hdr.magic, magic, sizeof(magic)) == 0 && bytes.size() == expected;
+}
+
+static void unpackKeypoints(const char *src, size_t n, vector<cv::KeyPoint> &keypoints)
+{
+    keypoints.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        DumpKeyPoint k;
+        memcpy(&k, src + i * sizeof(k), sizeof(k));
+        keypoints[i] = cv::KeyPoint(k.x, k.y, k.size, k.angle, k.response, k.octave, k.classId);
+    }
+}
+
+static bool writeEntry(const string &path, const CacheEntryHeader &hdr,
+                       const vector<cv::KeyPoint> &keypoints, const cv::Mat *descriptors)
+{
+    error_code ec;
+    filesystem::create_directories(filesystem::path(path).parent_path(), ec);
+
+    // Write under a private name and rename, so readers never see half an entry.
+    const string tmp = path + ".tmp" + to_string(getpid());
+    {
+        ofstream out(tmp, ios::binary | ios::trunc);
+        if (!out)
+            return false;
+        out.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+        for (const auto &kp : keypoints)
+        {
+            const DumpKeyPoint k = {kp.pt.x, kp.pt.y, kp.size, kp.angle, kp.response,
+                                    kp.octave, kp.class_id};
+            out.write(reinterpret_cast<const char *>(&k), sizeof(k));
+        }
+        if (descriptors)
+            for (int r = 0; r < descriptors->rows; ++r)
+                out.write(reinterpret_cast<const char *>(descriptors->ptr(r)), hdr.descRowBytes);
+        if (!out)
+            return false;
+    }
+    filesystem::rename(tmp, path, ec);
+    if (ec)
+        filesystem::remove(tmp, ec);
+    return !ec;
+}
+
+bool ResultCache::loadKeypoints(const string &key, vector<cv::KeyPoint> &keypoints)
+{
+    vector<char> bytes;
+    CacheEntryHeader hdr;
+    if (!readEntry(entryPath(key, ".kpts"), kKeypointMagic, bytes, hdr))
+    {
+        ++detectMisses_;
+        return false;
+    }
+    unpackKeypoints(bytes.data() + sizeof(hdr), hdr.numKeypoints, keypoints);
+    ++detectHits_;
+    return true;
+}
+
+bool ResultCache::loadDescriptors(const string &key, vector<cv::KeyPoint> &keypoints,
+                                  cv::Mat &descriptors)
+{
+    vector<char> bytes;
+    CacheEntryHeader hdr;
+    if (!readEntry(entryPath(key, ".desc"), kDescriptorMagic, bytes, hdr))
+    {
+        ++describeMisses_;
+        return false;
+    }
+    const char *p = bytes.data() + sizeof(hdr);
+    unpackKeypoints(p, hdr.numKeypoints, keypoints);
+    p += (size_t)hdr.numKeypoints * sizeof(DumpKeyPoint);
+
+    if (hdr.descType >= 0 && hdr.numKeypoints > 0)
+    {
+        descriptors.create((int)hdr.numKeypoints, (int)hdr.descCols, hdr.descType);
+        for (int r = 0; r < descriptors.rows; ++r)
+            memcpy(descriptors.ptr(r), p + (size_t)r * hdr.descRowBytes, hdr.descRowBytes);
+    }
+    else
+    {
+        descriptors.release();
+    }
+    ++describeHits_;
+    return true;
+}
+
+void ResultCache::storeKeypoints(const string &key, const vector<cv::KeyPoint> &keypoints)
+{
+    CacheEntryHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, kKeypointMagic, sizeof(hdr.magic));
+    hdr.numKeypoints = (uint32_t)keypoints.size();
+    hdr.descType     = -1;
+    if (!writeEntry(entryPath(key, ".kpts"), hdr, keypoints, nullptr))
+        cerr << "[WARN] ResultCache: could not store keypoints " << key << "\n";
+}
+
+void ResultCache::storeDescriptors(const string &key, const vector<cv::KeyPoint> &keypoints,
+                                   const cv::Mat &descriptors)
+{
+    if (!descriptors.empty() && (size_t)descriptors.rows != keypoints.size())
+        return; // inconsistent output; not worth caching
+
+    CacheEntryHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, kDescriptorMagic, sizeof(hdr.magic));
+    hdr.numKeypoints = (uint32_t)keypoints.size();
+    hdr.descType     = descriptors.empty() ? -1 : descriptors.type();
+    hdr.descCols     = (uint32_t)descriptors.cols;
+    hdr.descRowBytes = descriptors.empty() ? 0 : (uint32_t)(descriptors.cols * descriptors.elemSize());
+    if (!writeEntry(entryPath(key, ".desc"), hdr, keypoints, descriptors.empty() ? nullptr : &descriptors))
+        cerr << "[WARN] ResultCache: could not store descriptors " << key << "\n";
+}
@@ -0,0 +1,56 @@
+#ifndef resultCache_hpp
+#define resultCache_hpp
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include <opencv2/core.hpp>
+
+// ---------------------------------------------------------------------------
+// On-disk, content-addressed cache of detection and description outputs.
+//
+// A detection key hashes the image bytes, detector type and parameters, ROI,
+// OpenCV version and cache format version. A description key hashes the
+// detection key with the descriptor type and parameters, so changing only the
+// matcher hits both entries and changing only the descriptor still reuses the
+// detection. Entries live at <dir>/<2 hex>/<30 hex>.{kpts,desc} and are
+// written via rename, so concurrent runs never observe partial files.
+// ---------------------------------------------------------------------------
+class ResultCache
+{
+  public:
+    // Creates `dir` if needed. Throws std::runtime_error if it cannot.
+    explicit ResultCache(const std::string &dir);
+
+    std::string detectionKey(const cv::Mat &img, const std::string &detectorType,
+                             const std::string &detectorParams, const cv::Rect &roi) const;
+    std::string descriptionKey(const std::string &detectionKey, const std::string &descriptorType,
+                               const std::string &descriptorParams) const;
+
+    // Return true and fill the outputs on a hit. Corrupt entries count as misses.
+    bool loadKeypoints(const std::string &key, std::vector<cv::KeyPoint> &keypoints);
+    // Description can drop keypoints, so the surviving keypoints are stored too.
+    bool loadDescriptors(const std::string &key, std::vector<cv::KeyPoint> &keypoints,
+                         cv::Mat &descriptors);
+
+    // Failures to store are reported on stderr and otherwise ignored.
+    void storeKeypoints(const std::string &key, const std::vector<cv::KeyPoint> &keypoints);
+    void storeDescriptors(const std::string &key, const std::vector<cv::KeyPoint> &keypoints,
+                          const cv::Mat &descriptors);
+
+    size_t detectHits()     const { return detectHits_; }
+    size_t detectMisses()   const { return detectMisses_; }
+    size_t describeHits()   const { return describeHits_; }
+    size_t describeMisses() const { return describeMisses_; }
+
+  private:
+    std::string entryPath(const std::string &key, const char *ext) const;
+
+    std::string dir_;
+    size_t detectHits_ = 0, detectMisses_ = 0;
+    size_t describeHits_ = 0, describeMisses_ = 0;
+};
+
+#endif /* resultCache_hpp */
@@ -0,0 +1,139 @@
+/* Stand-in capture process for the shared-memory ingest mode.
+ *
+ * Replays the KITTI sequence into the "<name>.frames" ring and prints the
+ * records that 2D_feature_tracking --shm <name> sends back through
+ * "<name>.results". Start this first, then the tracker.
+ */
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include "dataStructures.h"
+#include "rawFrameStream.hpp"
+#include "shmRing.hpp"
+
+using namespace std;
+
+// Print one result record and hand its slot back to the tracker.
+static void printResult(ShmRing &results, const uint8_t *slot)
+{
+    StreamRecord rec;
+    memcpy(&rec, slot, sizeof(rec));
+    results.release();
+    cout << rec.frameIndex << "," << rec.numKeypoints << "," << rec.numMatches
+         << "," << rec.detectMs << "," << rec.describeMs << "," << rec.matchMs << "\n";
+}
+
+// Print every result record that is ready without blocking.
+static void drainResults(ShmRing &results)
+{
+    const uint8_t *p;
+    while ((p = results.tryAcquire()) != nullptr)
+        printResult(results, p);
+}
+
+int main(int argc, char *argv[])
+{
+    string name  = "ft2d";
+    int    slots = 4;
+    int    loops = 1;
+    double fps   = 0.0;   // 0 -> as fast as the consumer allows
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if      (arg == "--name"  && i + 1 < argc) name  = argv[++i];
+        else if (arg == "--slots" && i + 1 < argc) slots = atoi(argv[++i]);
+        else if (arg == "--loops" && i + 1 < argc) loops = atoi(argv[++i]);
+        else if (arg == "--fps"   && i + 1 < argc) fps   = atof(argv[++i]);
+        else { cerr << "Unknown argument: " << arg
+                    << "\nUsage: ./kitti_shm_producer [--name N] [--slots S] [--loops L] [--fps F]\n";
+               return 1; }
+    }
+
+    /* --- Load the KITTI sequence once --- */
+    vector<cv::Mat> images;
+    for (int idx = 0; idx <= 9; ++idx)
+    {
+        ostringstream path;
+        path << "../images/KITTI/2011_09_26/image_00/data/"
+             << setfill('0') << setw(10) << idx << ".png";
+        cv::Mat img = cv::imread(path.str(), cv::IMREAD_GRAYSCALE);
+        if (img.empty())
+        {
+            cerr << "[ERROR] could not open '" << path.str() << "'\n";
+            return 1;
+        }
+        images.push_back(img);
+    }
+
+    try
+    {
+        size_t maxBytes = 0;
+        for (const auto &img : images)
+            maxBytes = max(maxBytes, (size_t)img.cols * img.rows);
+
+        ShmRing frames(name + ".frames", ShmRing::Mode::CREATE,
+                       (uint32_t)slots, (uint32_t)(kShmPixelOffset + maxBytes));
+        ShmRing results(name + ".results", ShmRing::Mode::CREATE,
+                        (uint32_t)slots, (uint32_t)sizeof(StreamRecord));
+        cerr << "Rings '" << name << ".frames' / '" << name << ".results' ready; "
+             << "run: ./2D_feature_tracking --shm " << name << " --detector D --descriptor D\n";
+
+        cout << "Frame,NumKeypoints,NumMatches,DetectMs,DescribeMs,MatchMs\n";
+        const auto period = chrono::duration<double>(fps > 0.0 ? 1.0 / fps : 0.0);
+        auto nextDue = chrono::steady_clock::now();
+        uint32_t frameIndex = 0;
+
+        for (int loop = 0; loop < loops; ++loop)
+        {
+            for (const auto &img : images)
+            {
+                // Keep draining results while waiting so neither side can stall the other.
+                uint8_t *slot;
+                while ((slot = frames.tryClaim()) == nullptr)
+                {
+                    drainResults(results);
+                    this_thread::yield();
+                }
+
+                ShmFrameHeader hdr;
+                hdr.frameIndex = frameIndex++;
+                hdr.width      = (uint32_t)img.cols;
+                hdr.height     = (uint32_t)img.rows;
+                hdr.stride     = (uint32_t)img.cols;
+                memcpy(slot, &hdr, sizeof(hdr));
+                for (int r = 0; r < img.rows; ++r)
+                    memcpy(slot + kShmPixelOffset + (size_t)r * hdr.stride, img.ptr(r), img.cols);
+                frames.publish();
+
+                drainResults(results);
+                if (fps > 0.0)
+                {
+                    nextDue += chrono::duration_cast<chrono::steady_clock::duration>(period);
+                    this_thread::sleep_until(nextDue);
+                }
+            }
+        }
+        frames.close();
+
+        // Wait for the tracker to finish the tail of the sequence.
+        const uint8_t *p;
+        while ((p = results.acquire()) != nullptr)
+            printResult(results, p);
+    }
+    catch (const exception &e)
+    {
+        cerr << "[ERROR] " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "shmRing.hpp"
+
+using namespace std;
+
+static const uint32_t kShmRingMagic   = 0x46545252; // "FTRR"
+static const uint32_t kShmRingVersion = 1;
+
+// Busy-wait briefly, then yield: the fast path stays in user space while a
+// stalled peer does not burn a whole core.
+static void backoff(unsigned &spins)
+{
+    if (++spins < 256) return;
+    this_thread::yield();
+    if (spins > 4096)
+        this_thread::sleep_for(chrono::microseconds(50));
+}
+
+static size_t headerBytes()
+{
+    return (sizeof(ShmRingHeader) + 63) & ~size_t(63);
+}
+
+// ---------------------------------------------------------------------------
+// Construction / teardown
+// ---------------------------------------------------------------------------
+ShmRing::ShmRing(const string &name, Mode mode, uint32_t slotCount, uint32_t slotBytes,
+                 int openTimeoutMs)
+    : name_(!name.empty() && name[0] == '/' ? name : "/" + name), owner_(mode == Mode::CREATE)
+{
+    int fd = -1;
+    if (owner_)
+    {
+        if (slotCount < 2 || slotBytes == 0)
+            throw invalid_argument("ShmRing: need >= 2 slots of non-zero size");
+        slotBytes = (slotBytes + 63) & ~uint32_t(63);
+        mappedBytes_ = headerBytes() + (size_t)slotCount * slotBytes;
+
+        shm_unlink(name_.c_str()); // drop a stale segment from a crashed run
+        fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+            throw runtime_error("ShmRing: shm_open('" + name_ + "') failed: " + strerror(errno));
+        if (ftruncate(fd, (off_t)mappedBytes_) != 0)
+        {
+            ::close(fd);
+            throw runtime_error("ShmRing: ftruncate failed: " + string(strerror(errno)));
+        }
+    }
+    else
+    {
+        const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(openTimeoutMs);
+        while ((fd = shm_open(name_.c_str(), O_RDWR, 0600)) < 0)
+        {
+            if (errno != ENOENT || chrono::steady_clock::now() > deadline)
+                throw runtime_error("ShmRing: shm_open('" + name_ + "') failed: " + strerror(errno));
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+        // The creator sizes the segment right after creating it; wait for that too.
+        struct stat st;
+        do
+        {
+            if (fstat(fd, &st) != 0)
+            {
+                ::close(fd);
+                throw runtime_error("ShmRing: fstat failed: " + string(strerror(errno)));
+            }
+            if ((size_t)st.st_size >= headerBytes()) break;
+            this_thread::sleep_for(chrono::milliseconds(1));
+        } while (chrono::steady_clock::now() < deadline);
+        mappedBytes_ = (size_t)st.st_size;
+    }
+
+    void *base = mmap(nullptr, mappedBytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED)
+        throw runtime_error("ShmRing: mmap failed: " + string(strerror(errno)));
+
+    header_ = static_cast<ShmRingHeader *>(base);
+    slots_  = static_cast<uint8_t *>(base) + headerBytes();
+
+    if (owner_)
+    {
+        new (header_) ShmRingHeader();
+        header_->slotCount = slotCount;
+        header_->slotBytes = slotBytes;
+        header_->head.store(0, memory_order_relaxed);
+        header_->tail.store(0, memory_order_relaxed);
+        header_->closed.store(0, memory_order_relaxed);
+        header_->version = kShmRingVersion;
+        // Publishing the magic last tells the opener the header is complete.
+        header_->magic.store(kShmRingMagic, memory_order_release);
+    }
+    else
+    {
+        const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(openTimeoutMs);
+        while (header_->magic.load(memory_order_acquire) != kShmRingMagic
+               && chrono::steady_clock::now() < deadline)
+            this_thread::sleep_for(chrono::milliseconds(1));
+        if (header_->magic.load(memory_order_acquire) != kShmRingMagic || header_->version != kShmRingVersion
+            || headerBytes() + (size_t)header_->slotCount * header_->slotBytes > mappedBytes_)
+        {
+            munmap(base, mappedBytes_);
+            throw runtime_error("ShmRing: '" + name_ + "' is not a compatible ring");
+        }
+        readSeq_ = header_->tail.load(memory_order_acquire);
+    }
+}
+
+ShmRing::~ShmRing()
+{
+    if (header_)
+        munmap(header_, mappedBytes_);
+    if (owner_)
+        shm_unlink(name_.c_str());
+}
+
+uint8_t *ShmRing::slot(uint64_t seq) const
+{
+    return slots_ + (size_t)(seq % header_->slotCount) * header_->slotBytes;
+}
+
+// ---------------------------------------------------------------------------
+// Producer side
+// ---------------------------------------------------------------------------
+uint8_t *ShmRing::tryClaim()
+{
+    const uint64_t head = header_->head.load(memory_order_relaxed);
+    const uint64_t tail = header_->tail.load(memory_order_acquire);
+    if (head - tail >= header_->slotCount)
+        return nullptr;
+    return slot(head);
+}
+
+uint8_t *ShmRing::claim()
+{
+    unsigned spins = 0;
+    uint8_t *p;
+    while ((p = tryClaim()) == nullptr)
+        backoff(spins);
+    return p;
+}
+
+void ShmRing::publish()
+{
+    header_->head.store(header_->head.load(memory_order_relaxed) + 1, memory_order_release);
+}
+
+void ShmRing::close()
+{
+    header_->closed.store(1, memory_order_release);
+}
+
+// ---------------------------------------------------------------------------
+// Consumer side
+// ---------------------------------------------------------------------------
+const uint8_t *ShmRing::tryAcquire()
+{
+    if (readSeq_ >= header_->head.load(memory_order_acquire))
+        return nullptr;
+    return slot(readSeq_++);
+}
+
+const uint8_t *ShmRing::acquire()
+{
+    unsigned spins = 0;
+    for (;;)
+    {
+        if (const uint8_t *p = tryAcquire())
+            return p;
+        // Check closed before re-checking head so a final publish is not missed.
+        if (header_->closed.load(memory_order_acquire))
+            return tryAcquire();
+        backoff(spins);
+    }
+}
+
+void ShmRing::release()
+{
+    const uint64_t tail = header_->tail.load(memory_order_relaxed);
+    if (tail < readSeq_)
+        header_->tail.store(tail + 1, memory_order_release);
+}
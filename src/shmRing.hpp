@@ -0,0 +1,96 @@
+#ifndef shmRing_hpp
+#define shmRing_hpp
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+
+// ---------------------------------------------------------------------------
+// Single-producer / single-consumer ring of fixed-size slots in POSIX shared
+// memory. The producer advances `head` after filling a slot, the consumer
+// advances `tail` after it is done with the oldest slot it holds. Both
+// counters are monotonically increasing 64-bit sequence numbers, so a slot
+// index is simply `seq % slotCount` and no locks are involved.
+// ---------------------------------------------------------------------------
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory ring needs lock-free 64-bit atomics");
+
+// Control block at the start of the mapping. Counters sit on separate cache
+// lines so producer and consumer never write the same line.
+struct ShmRingHeader
+{
+    std::atomic<uint32_t> magic;  // stored last by the creator
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotBytes;   // payload bytes per slot, multiple of 64
+    alignas(64) std::atomic<uint64_t> head;   // written by the producer only
+    alignas(64) std::atomic<uint64_t> tail;   // written by the consumer only
+    alignas(64) std::atomic<uint32_t> closed; // producer has published its last slot
+};
+
+// Payload layout of one slot in the frame ring; pixels start at kShmPixelOffset.
+struct ShmFrameHeader
+{
+    uint32_t frameIndex;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;  // bytes per row
+};
+static const size_t kShmPixelOffset = 64;
+
+class ShmRing
+{
+  public:
+    enum class Mode { CREATE, OPEN };
+
+    // CREATE makes (or replaces) the segment and owns it: it is unlinked on
+    // destruction. OPEN attaches to an existing segment, retrying for up to
+    // openTimeoutMs while the creator starts up.
+    // Throws std::invalid_argument on bad geometry, std::runtime_error on
+    // shm_open/mmap failures or a layout mismatch.
+    ShmRing(const std::string &name, Mode mode,
+            uint32_t slotCount = 0, uint32_t slotBytes = 0,
+            int openTimeoutMs = 10000);
+    ~ShmRing();
+
+    ShmRing(const ShmRing &) = delete;
+    ShmRing &operator=(const ShmRing &) = delete;
+
+    uint32_t slotCount() const { return header_->slotCount; }
+    uint32_t slotBytes() const { return header_->slotBytes; }
+
+    /* --- producer side --- */
+    // Returns the next free slot, or nullptr if the ring is full.
+    uint8_t *tryClaim();
+    // Spins (then yields) until a slot is free.
+    uint8_t *claim();
+    // Makes the slot returned by the last claim visible to the consumer.
+    void publish();
+    // No more slots will be published.
+    void close();
+
+    /* --- consumer side --- */
+    // Returns the next published slot without releasing earlier ones, or
+    // nullptr if none is ready yet.
+    const uint8_t *tryAcquire();
+    // Waits for the next slot; returns nullptr once the ring is closed and drained.
+    const uint8_t *acquire();
+    // Hands the oldest acquired slot back to the producer.
+    void release();
+    // Number of slots acquired but not yet released.
+    uint64_t held() const { return readSeq_ - header_->tail.load(std::memory_order_relaxed); }
+
+  private:
+    uint8_t *slot(uint64_t seq) const;
+
+    std::string name_;
+    bool owner_;
+    size_t mappedBytes_ = 0;
+    ShmRingHeader *header_ = nullptr;
+    uint8_t *slots_ = nullptr;
+    uint64_t readSeq_ = 0;   // consumer's private acquire cursor
+};
+
+#endif /* shmRing_hpp */
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "stereoMatcher.hpp"
+#include "descriptorDistance.hpp"
+
+using namespace std;
+
+RowBucketIndex::RowBucketIndex(const vector<cv::KeyPoint> &keypoints) : keypoints_(keypoints)
+{
+    int maxRow = -1;
+    for (const auto &kp : keypoints)
+        maxRow = max(maxRow, (int)floor(kp.pt.y));
+    rows_.resize(maxRow + 1);
+
+    for (int i = 0; i < (int)keypoints.size(); ++i)
+    {
+        const cv::Point2f &p = keypoints[i].pt;
+        if (p.y >= 0.f)
+            rows_[(int)floor(p.y)].push_back({p.x, i});
+    }
+    for (auto &bucket : rows_)
+        sort(bucket.begin(), bucket.end(), [](const Entry &a, const Entry &b) { return a.x < b.x; });
+}
+
+StereoMatcher::StereoMatcher(bool binaryDescriptors, const StereoConfig &config)
+    : normType_(binaryDescriptors ? cv::NORM_HAMMING : cv::NORM_L2), config_(config)
+{
+    if (config.rowBand < 0.f || config.minDisparity <= 0.f || config.maxDisparity <= config.minDisparity)
+        throw invalid_argument("StereoMatcher: need rowBand >= 0 and 0 < minDisparity < maxDisparity");
+}
+
+void StereoMatcher::match(const vector<cv::KeyPoint> &kptsLeft, const cv::Mat &descLeft,
+                          const vector<cv::KeyPoint> &kptsRight, const cv::Mat &descRight,
+                          vector<StereoMatch> &matches, StereoStats *stats) const
+{
+    const double t = (double)cv::getTickCount();
+    StereoStats local;
+    StereoStats &st = stats ? *stats : local;
+    st = StereoStats();
+    matches.clear();
+
+    if (descLeft.empty() || descRight.empty())
+        return;
+    if ((size_t)descLeft.rows != kptsLeft.size() || (size_t)descRight.rows != kptsRight.size())
+        throw invalid_argument("StereoMatcher::match: descriptor rows do not match keypoints");
+
+    const RowBucketIndex index(kptsRight);
+    const bool ratioTest = config_.ratio < 1.0f;
+    for (int i = 0; i < (int)kptsLeft.size(); ++i)
+    {
+        const cv::Point2f &pl = kptsLeft[i].pt;
+        float best = numeric_limits<float>::max(), second = best;
+        int bestIdx = -1;
+
+        // Matches sit left of the left-image position: xR = xL - disparity.
+        index.forEachCandidate(pl.y, config_.rowBand,
+                               pl.x - config_.maxDisparity, pl.x - config_.minDisparity,
+                               [&](int j) {
+                                   const float d = descriptorDistance(descLeft, i, descRight, j, normType_);
+                                   ++st.comparisons;
+                                   if (d < best) { second = best; best = d; bestIdx = j; }
+                                   else if (d < second) second = d;
+                               });
+
+        if (bestIdx < 0 || (ratioTest && second != numeric_limits<float>::max()
+                            && best >= config_.ratio * second))
+            continue;
+
+        StereoMatch m;
+        m.leftIdx   = i;
+        m.rightIdx  = bestIdx;
+        m.distance  = best;
+        m.disparity = pl.x - kptsRight[bestIdx].pt.x;
+        m.depthM    = (float)(config_.focalPx * config_.baselineM / m.disparity);
+        matches.push_back(m);
+    }
+
+    st.bruteForce = kptsLeft.size() * kptsRight.size();
+    st.matchMs    = 1000.0 * ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+}
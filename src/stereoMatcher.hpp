@@ -0,0 +1,97 @@
+#ifndef stereoMatcher_hpp
+#define stereoMatcher_hpp
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <opencv2/core.hpp>
+
+// ---------------------------------------------------------------------------
+// Stereo matching between rectified left/right frames.
+//
+// After rectification a point's match lies on (almost) the same image row,
+// at a smaller x in the right image. Right keypoints are bucketed by row and
+// sorted by x, so each left keypoint is only compared against the few right
+// keypoints within +-rowBand rows and the disparity range, instead of every
+// right keypoint as in a brute-force match.
+// ---------------------------------------------------------------------------
+struct StereoConfig
+{
+    float  rowBand      = 2.0f;       // max |yL - yR| in pixels
+    float  minDisparity = 1.0f;       // xL - xR range in pixels
+    float  maxDisparity = 160.0f;
+    float  ratio        = 0.8f;       // best < ratio * second best; >= 1 disables
+    double focalPx      = 721.5377;   // KITTI 2011_09_26 P_rect_00
+    double baselineM    = 0.5372;     // -P_rect_01[0][3] / f (image_00 <-> image_01)
+};
+
+struct StereoMatch
+{
+    int   leftIdx, rightIdx;
+    float distance;                   // descriptor distance
+    float disparity;                  // xL - xR, pixels
+    float depthM;                     // focalPx * baselineM / disparity
+};
+
+struct StereoStats
+{
+    size_t comparisons = 0;           // descriptor distances computed
+    size_t bruteForce  = 0;           // what a full left x right match would compute
+    double matchMs     = 0.0;
+};
+
+// Right-image keypoints bucketed by integer row, each bucket sorted by x.
+class RowBucketIndex
+{
+  public:
+    explicit RowBucketIndex(const std::vector<cv::KeyPoint> &keypoints);
+
+    // Call fn(index) for every keypoint with |y - row| <= band and x in [xMin, xMax].
+    template <class Fn>
+    void forEachCandidate(float row, float band, float xMin, float xMax, Fn fn) const;
+
+  private:
+    struct Entry { float x; int idx; };
+    std::vector<std::vector<Entry>> rows_;
+    const std::vector<cv::KeyPoint> &keypoints_;
+};
+
+class StereoMatcher
+{
+  public:
+    // Throws std::invalid_argument on a negative band or a disparity range
+    // that is empty or not strictly positive.
+    StereoMatcher(bool binaryDescriptors, const StereoConfig &config);
+
+    // One match per left keypoint at most; descriptor rows follow keypoint order.
+    void match(const std::vector<cv::KeyPoint> &kptsLeft, const cv::Mat &descLeft,
+               const std::vector<cv::KeyPoint> &kptsRight, const cv::Mat &descRight,
+               std::vector<StereoMatch> &matches, StereoStats *stats = nullptr) const;
+
+    const StereoConfig &config() const { return config_; }
+
+  private:
+    int normType_;
+    StereoConfig config_;
+};
+
+// ---------------------------------------------------------------------------
+template <class Fn>
+void RowBucketIndex::forEachCandidate(float row, float band, float xMin, float xMax, Fn fn) const
+{
+    const int first = std::max(0, (int)std::floor(row - band));
+    const int last  = std::min((int)rows_.size() - 1, (int)std::floor(row + band));
+    for (int r = first; r <= last; ++r)
+    {
+        const std::vector<Entry> &bucket = rows_[r];
+        auto it = std::lower_bound(bucket.begin(), bucket.end(), xMin,
+                                   [](const Entry &e, float x) { return e.x < x; });
+        for (; it != bucket.end() && it->x <= xMax; ++it)
+            if (std::fabs(keypoints_[it->idx].pt.y - row) <= band)
+                fn(it->idx);
+    }
+}
+
+#endif /* stereoMatcher_hpp */
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "threadPool.hpp"
+
+using namespace std;
+
+// Returns the CPU the thread was bound to, or -1.
+static int pinThread(thread &t, size_t index)
+{
+#ifdef __linux__
+    const unsigned cpus = thread::hardware_concurrency();
+    if (cpus == 0)
+        return -1;
+    const int cpu = (int)(index % cpus);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(t.native_handle(), sizeof(set), &set) != 0)
+    {
+        cerr << "[WARN] ThreadPool: could not pin worker " << index << " to CPU " << cpu << "\n";
+        return -1;
+    }
+    return cpu;
+#else
+    (void)t; (void)index;
+    return -1;
+#endif
+}
+
+ThreadPool::ThreadPool(size_t workers, bool pinThreads)
+{
+    if (workers == 0)
+        throw invalid_argument("ThreadPool: need at least one worker");
+
+    for (size_t i = 0; i < workers; ++i)
+    {
+        workers_.emplace_back(new Worker());
+        Worker &w = *workers_.back();
+        w.thread = thread(&ThreadPool::workerLoop, std::ref(w));
+        if (pinThreads)
+            w.cpu = pinThread(w.thread, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    close();
+}
+
+void ThreadPool::close()
+{
+    for (auto &w : workers_)
+    {
+        {
+            lock_guard<mutex> lock(w->mutex);
+            w->stopping = true;
+        }
+        w->notEmpty.notify_all();
+    }
+    for (auto &w : workers_)
+        if (w->thread.joinable())
+            w->thread.join();
+}
+
+future<void> ThreadPool::submitTo(size_t worker, function<void()> task)
+{
+    Worker &w = *workers_.at(worker);
+    packaged_task<void()> job(std::move(task));
+    future<void> done = job.get_future();
+    {
+        lock_guard<mutex> lock(w.mutex);
+        if (w.stopping)
+            throw logic_error("ThreadPool::submitTo: pool is closed");
+        w.queue.push_back(std::move(job));
+    }
+    w.notEmpty.notify_one();
+    return done;
+}
+
+future<void> ThreadPool::submit(function<void()> task)
+{
+    size_t worker;
+    {
+        lock_guard<mutex> lock(nextMutex_);
+        worker = next_++ % workers_.size();
+    }
+    return submitTo(worker, std::move(task));
+}
+
+void ThreadPool::workerLoop(Worker &w)
+{
+    for (;;)
+    {
+        packaged_task<void()> job;
+        {
+            unique_lock<mutex> lock(w.mutex);
+            w.notEmpty.wait(lock, [&w] { return w.stopping || !w.queue.empty(); });
+            if (w.queue.empty())
+                return;   // stopping and drained
+            job = std::move(w.queue.front());
+            w.queue.pop_front();
+        }
+        job();
+    }
+}
+
+ThreadPool &sharedThreadPool()
+{
+    static ThreadPool *pool = new ThreadPool(max(1u, thread::hardware_concurrency()));   // never joined
+    return *pool;
+}
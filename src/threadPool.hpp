@@ -0,0 +1,68 @@
+#ifndef threadPool_hpp
+#define threadPool_hpp
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+
+// ---------------------------------------------------------------------------
+// Fixed-size worker pool with one queue per worker.
+//
+// submitTo(w, task) always runs on worker w, so work keyed by a stable index
+// (a camera, a row chunk) keeps its caches and, with pinning, its core.
+// submit(task) spreads tasks round-robin. Exceptions thrown by a task are
+// delivered through its future.
+// ---------------------------------------------------------------------------
+class ThreadPool
+{
+  public:
+    // pinThreads: bind worker w to CPU w % hardware_concurrency (Linux only;
+    // ignored elsewhere and when binding fails). Throws std::invalid_argument
+    // if workers is 0.
+    explicit ThreadPool(size_t workers, bool pinThreads = false);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    std::future<void> submitTo(size_t worker, std::function<void()> task);
+    std::future<void> submit(std::function<void()> task);
+
+    // Run queued tasks to completion and join the workers; called by the destructor.
+    void close();
+
+    // CPU each worker was bound to, or -1 if it is not pinned.
+    int pinnedCpu(size_t worker) const { return workers_[worker]->cpu; }
+
+  private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::condition_variable notEmpty;
+        std::deque<std::packaged_task<void()>> queue;
+        bool stopping = false;
+        int cpu = -1;
+        std::thread thread;
+    };
+
+    static void workerLoop(Worker &worker);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex nextMutex_;
+    size_t next_ = 0;
+};
+
+// Process-wide pool for data-parallel stages (one unpinned worker per
+// hardware thread), created on first use. A task running on it must not wait
+// for other tasks on it.
+ThreadPool &sharedThreadPool();
+
+#endif /* threadPool_hpp */